@@ -0,0 +1,428 @@
+/*
+ * Micro benchmarks of the hot paths, run against the recorded responses in
+ * bench/corpus:
+ *
+ *     make bench
+ *     ./build/bench/bench bench/corpus [name filter]
+ *
+ * Each benchmark is run for at least BENCH_MIN_TIME_MS and reported as
+ * time, heap allocations and heap bytes per operation. Allocations are
+ * counted by the operator new below, so only the benchmark thread may run.
+ */
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MIN_TIME_MS 250
+#define BENCH_UPLOAD_SIZE (4 * 1024 * 1024)
+#define BENCH_UPLOAD_CHUNK (16 * 1024)
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+static long allocations = 0;
+static long allocated_bytes = 0;
+
+void* operator new(size_t size) {
+    allocations ++;
+    allocated_bytes += size;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// results are written here so the compiler cannot drop the work
+static volatile long sink = 0;
+
+struct Corpus {
+    std::string file_list;
+    std::string change_list;
+    std::string about;
+    std::string errors[3];
+    std::string upload_headers;
+    std::vector<std::string> header_lines;
+    std::string upload_path;
+};
+
+static Corpus corpus;
+
+static std::string load(const std::string& dir, const char* name) {
+    std::string path = dir + "/" + name;
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "cannot read %s\n", path.c_str());
+        exit(1);
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+typedef void (*BenchFunction)(long n);
+
+struct Benchmark {
+    const char* name;
+    BenchFunction function;
+    // payload bytes of one operation, 0 when throughput means nothing
+    long bytes;
+};
+
+/* decoding */
+
+static void bench_file_list(long n) {
+    JsonReader reader;
+    for (long i = 0; i < n; i ++) {
+        reader.reset(corpus.file_list.data(), corpus.file_list.size());
+        GFileList list;
+        list.from_json(reader);
+        sink += list.get_items().size();
+    }
+}
+
+static void bench_file_list_dom(long n) {
+    for (long i = 0; i < n; i ++) {
+        PError error;
+        JObject* obj = (JObject*)loads(corpus.file_list, error);
+        GFileList list;
+        list.from_json(obj);
+        delete obj;
+        sink += list.get_items().size();
+    }
+}
+
+static void bench_file_list_projection(long n) {
+    JsonReader reader;
+    FieldMask projection = FIELD_BIT(GFile::F_id) | FIELD_BIT(GFile::F_title) | FIELD_BIT(GFile::F_mimeType)
+        | FIELD_BIT(GFile::F_parents) | FIELD_BIT(GFile::F_modifiedDate) | FIELD_BIT(GFile::F_fileSize);
+    for (long i = 0; i < n; i ++) {
+        reader.reset(corpus.file_list.data(), corpus.file_list.size());
+        GFileList list;
+        list.from_json(reader, projection);
+        sink += list.get_items().size();
+    }
+}
+
+static void bench_change_list(long n) {
+    JsonReader reader;
+    for (long i = 0; i < n; i ++) {
+        reader.reset(corpus.change_list.data(), corpus.change_list.size());
+        GChangeList list;
+        list.from_json(reader);
+        sink += list.get_items().size();
+    }
+}
+
+static void bench_about(long n) {
+    JsonReader reader;
+    for (long i = 0; i < n; i ++) {
+        reader.reset(corpus.about.data(), corpus.about.size());
+        GAbout about;
+        about.from_json(reader);
+        sink += about.get_quotaBytesUsed();
+    }
+}
+
+static void bench_error(long n) {
+    JsonReader reader;
+    for (long i = 0; i < n; i ++) {
+        const std::string& body = corpus.errors[i % 3];
+        reader.reset(body.data(), body.size());
+        GError error;
+        error.from_json(reader);
+        sink += error.get_code();
+    }
+}
+
+/* encoding */
+
+static GFile first_file() {
+    JsonReader reader(corpus.file_list);
+    GFileList list;
+    list.from_json(reader);
+    return list.get_items()[0];
+}
+
+static void bench_file_to_json(long n) {
+    GFile file = first_file();
+    JsonWriter writer;
+    for (long i = 0; i < n; i ++) {
+        writer.reset();
+        file.to_json(writer);
+        sink += writer.str().size();
+    }
+}
+
+// what _json_encode_body does for a metadata update
+static void bench_encode_body(long n) {
+    GFile file;
+    file.set_title("quarterly report (final).pdf");
+    file.set_description("numbers for the \"board\" meeting");
+    std::vector<GParent> parents(1);
+    parents[0].set_id("0B4fcOf7HyeUKZ2VuRzJaV3BHb1k");
+    file.set_parents(parents);
+    FieldMask fields = file.get_modified_mask();
+    JsonWriter writer;
+    std::string body;
+    for (long i = 0; i < n; i ++) {
+        writer.reset();
+        file.to_json(writer, fields);
+        writer.swap(body);
+        sink += body.size();
+    }
+}
+
+/* urls */
+
+static const char* QUERY = "'0B4fcOf7HyeUKZ2VuRzJaV3BHb1k' in parents and trashed = false and title contains 'résumé 2014'";
+
+static void bench_url_encode(long n) {
+    std::string query = QUERY;
+    for (long i = 0; i < n; i ++) {
+        std::string encoded = URLHelper::encode(query);
+        sink += encoded.size();
+    }
+}
+
+static void bench_url_encode_append(long n) {
+    std::string query = QUERY;
+    std::string encoded;
+    for (long i = 0; i < n; i ++) {
+        encoded.clear();
+        URLHelper::encode(query.data(), query.size(), encoded);
+        sink += encoded.size();
+    }
+}
+
+static void bench_url_decode(long n) {
+    std::string encoded = URLHelper::encode(QUERY);
+    std::string decoded;
+    for (long i = 0; i < n; i ++) {
+        decoded.clear();
+        URLHelper::decode(encoded.data(), encoded.size(), decoded);
+        sink += decoded.size();
+    }
+}
+
+/* response headers */
+
+static void feed_headers(HttpResponse& resp) {
+    for (int j = 0; j < corpus.header_lines.size(); j ++) {
+        const std::string& line = corpus.header_lines[j];
+        HttpResponse::curl_header_callback((void*)line.data(), 1, line.size(), (void*)&resp);
+    }
+}
+
+static void bench_header_parse(long n) {
+    HttpResponse resp;
+    for (long i = 0; i < n; i ++) {
+        resp.clear();
+        feed_headers(resp);
+        resp._parse_header();
+        const char* value;
+        size_t length;
+        if (resp.find_header("range", value, length)) {
+            sink += length;
+        }
+    }
+}
+
+static void bench_header_get(long n) {
+    HttpResponse resp;
+    feed_headers(resp);
+    std::string range = "Range";
+    for (long i = 0; i < n; i ++) {
+        sink += resp.get_header(range).size();
+    }
+}
+
+/* dates */
+
+static void bench_epoch_ms_from_string(long n) {
+    const char* date = "2014-10-19T18:51:02.123Z";
+    size_t size = strlen(date);
+    for (long i = 0; i < n; i ++) {
+        sink += epoch_ms_from_string(date, size);
+    }
+}
+
+static void bench_time_from_string(long n) {
+    std::string date = "2014-10-19T18:51:02.123Z";
+    for (long i = 0; i < n; i ++) {
+        struct tm t = time_from_string(date);
+        sink += t.tm_sec;
+    }
+}
+
+/* upload read callbacks, one operation is one BENCH_UPLOAD_CHUNK curl asks for */
+
+class RewindableContent : public FileContent {
+    public:
+        RewindableContent(std::ifstream& fin)
+            :FileContent(fin, "application/octet-stream") {}
+        void rewind() {
+            _resumable_cur_pos = 0;
+            set_resumable_start_pos(0);
+            set_resumable_length(get_length());
+        }
+};
+
+static void bench_read(long n) {
+    long start = allocations, start_bytes = allocated_bytes;
+    std::ifstream fin(corpus.upload_path.c_str(), std::ios::binary);
+    FileContent content(fin, "application/octet-stream");
+    std::vector<char> chunk(BENCH_UPLOAD_CHUNK);
+    long setup = allocations - start, setup_bytes = allocated_bytes - start_bytes;
+    for (long i = 0; i < n; i ++) {
+        // returns 0 and seeks back at the end of the file
+        sink += FileContent::read(&chunk[0], 1, chunk.size(), &content);
+    }
+    // the stream and the buffer are setup, not part of an operation
+    allocations -= setup;
+    allocated_bytes -= setup_bytes;
+}
+
+static void bench_resumable_read(long n) {
+    long start = allocations, start_bytes = allocated_bytes;
+    std::ifstream fin(corpus.upload_path.c_str(), std::ios::binary);
+    RewindableContent content(fin);
+    content.rewind();
+    std::vector<char> chunk(BENCH_UPLOAD_CHUNK);
+    long setup = allocations - start, setup_bytes = allocated_bytes - start_bytes;
+    for (long i = 0; i < n; i ++) {
+        size_t length = FileContent::resumable_read(&chunk[0], 1, chunk.size(), &content);
+        if (length == 0) {
+            content.rewind();
+        }
+        sink += length;
+    }
+    allocations -= setup;
+    allocated_bytes -= setup_bytes;
+}
+
+static Benchmark BENCHMARKS[] = {
+    {"decode/file_list_1000", bench_file_list, 0},
+    {"decode/file_list_1000_dom", bench_file_list_dom, 0},
+    {"decode/file_list_1000_projection", bench_file_list_projection, 0},
+    {"decode/change_list_500", bench_change_list, 0},
+    {"decode/about", bench_about, 0},
+    {"decode/error", bench_error, 0},
+    {"encode/file_all_fields", bench_file_to_json, 0},
+    {"encode/update_body", bench_encode_body, 0},
+    {"url/encode", bench_url_encode, 0},
+    {"url/encode_append", bench_url_encode_append, 0},
+    {"url/decode", bench_url_decode, 0},
+    {"header/parse", bench_header_parse, 0},
+    {"header/get", bench_header_get, 0},
+    {"time/epoch_ms_from_string", bench_epoch_ms_from_string, 0},
+    {"time/time_from_string", bench_time_from_string, 0},
+    {"upload/read", bench_read, BENCH_UPLOAD_CHUNK},
+    {"upload/resumable_read", bench_resumable_read, BENCH_UPLOAD_CHUNK},
+};
+
+static void run(const Benchmark& bench) {
+    long n = 1;
+    long long elapsed;
+    long allocs, bytes;
+    while (true) {
+        allocations = allocated_bytes = 0;
+        long long begin = now_ns();
+        bench.function(n);
+        elapsed = now_ns() - begin;
+        allocs = allocations;
+        bytes = allocated_bytes;
+        if (elapsed >= BENCH_MIN_TIME_MS * 1000000LL || n >= 1000000000L) {
+            break;
+        }
+        // aim a little past the minimum, grow at most 100 times per round
+        long long next = elapsed > 0 ? (long long)n * BENCH_MIN_TIME_MS * 1200000LL / elapsed : n * 100LL;
+        if (next > n * 100LL) {
+            next = n * 100LL;
+        }
+        n = next > n ? next : n + 1;
+    }
+    printf("%-36s %10ld %14.1f ns/op %10.1f allocs/op %12.1f B/op",
+           bench.name, n, (double)elapsed / n, (double)allocs / n, (double)bytes / n);
+    if (bench.bytes > 0) {
+        printf(" %10.1f MB/s", (double)bench.bytes * n / elapsed * 1000);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static void load_corpus(const std::string& dir) {
+    corpus.file_list = load(dir, "file_list.json");
+    corpus.change_list = load(dir, "change_list.json");
+    corpus.about = load(dir, "about.json");
+    corpus.errors[0] = load(dir, "error_401.json");
+    corpus.errors[1] = load(dir, "error_403.json");
+    corpus.errors[2] = load(dir, "error_404.json");
+
+    // handed to the header callback a line at a time, as curl does
+    corpus.upload_headers = load(dir, "upload_headers.txt");
+    size_t start = 0;
+    while (start < corpus.upload_headers.size()) {
+        size_t end = corpus.upload_headers.find("\r\n", start);
+        end = end == std::string::npos ? corpus.upload_headers.size() : end + 2;
+        corpus.header_lines.push_back(corpus.upload_headers.substr(start, end - start));
+        start = end;
+    }
+
+    char path[] = "/tmp/gdrive_benchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "cannot create the upload file\n");
+        exit(1);
+    }
+    std::vector<char> data(BENCH_UPLOAD_SIZE);
+    for (int i = 0; i < data.size(); i ++) {
+        data[i] = (char)(i * 131 + 7);
+    }
+    if (write(fd, &data[0], data.size()) != (ssize_t)data.size()) {
+        fprintf(stderr, "cannot write the upload file\n");
+        exit(1);
+    }
+    close(fd);
+    corpus.upload_path = path;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s corpus_dir [name filter]\n", argv[0]);
+        return 1;
+    }
+    const char* filter = argc > 2 ? argv[2] : NULL;
+    load_corpus(argv[1]);
+    for (int i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i ++) {
+        if (filter == NULL || strstr(BENCHMARKS[i].name, filter) != NULL) {
+            run(BENCHMARKS[i]);
+        }
+    }
+    unlink(corpus.upload_path.c_str());
+    return 0;
+}
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Regenerates the benchmark corpus. The output is deterministic, rerun it
+only when the shape of the recorded responses should change."""
+
+import json
+import os
+import random
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+API = "https://www.googleapis.com/drive/v2"
+rng = random.Random(20141019)
+
+ALPHABET = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-"
+WORDS = ["report", "budget", "notes", "draft", "final", "meeting", "photo", "invoice",
+         "plan", "design", "résumé", "übersicht", "資料", "presentation", "backup", "q3"]
+OWNERS = [("Alice Chen", "alice@example.com", "01772378432958162873"),
+          ("Bob Martin", "bob@example.com", "14025987135437265309"),
+          ("Carla Díaz", "carla@example.com", "08235961738260417123")]
+KINDS = [
+    ("application/vnd.google-apps.folder", None),
+    ("application/vnd.google-apps.document", None),
+    ("application/vnd.google-apps.spreadsheet", None),
+    ("application/pdf", "pdf"),
+    ("image/jpeg", "jpg"),
+    ("text/plain", "txt"),
+]
+FOLDERS = ["0B" + "".join(rng.choice(ALPHABET) for _ in range(26)) for _ in range(40)]
+
+
+def file_id():
+    return "0B" + "".join(rng.choice(ALPHABET) for _ in range(26))
+
+
+def date():
+    return "2014-%02d-%02dT%02d:%02d:%02d.%03dZ" % (
+        rng.randint(1, 12), rng.randint(1, 28), rng.randint(0, 23),
+        rng.randint(0, 59), rng.randint(0, 59), rng.randint(0, 999))
+
+
+def user(owner):
+    name, email, permission = owner
+    return {"kind": "drive#user", "displayName": name,
+            "picture": {"url": "https://lh3.googleusercontent.com/-x/AAAAAAAAAAI/AAAAAAAAAAA/photo.jpg"},
+            "isAuthenticatedUser": owner is OWNERS[0], "permissionId": permission, "emailAddress": email}
+
+
+def gfile():
+    fid = file_id()
+    mime, ext = rng.choice(KINDS)
+    owner = rng.choice(OWNERS)
+    title = " ".join(rng.choice(WORDS) for _ in range(rng.randint(1, 4)))
+    if ext:
+        title += "." + ext
+    parent = rng.choice(FOLDERS)
+    item = {
+        "kind": "drive#file",
+        "id": fid,
+        "etag": "\"Hx5cT8mYtPLqbHUAQXxeQvxbqTg/MTQxMzU2NzY2MzE3Mg\"",
+        "selfLink": API + "/files/" + fid,
+        "alternateLink": "https://drive.google.com/file/d/" + fid + "/view?usp=drivesdk",
+        "iconLink": "https://ssl.gstatic.com/docs/doclist/images/icon_11_" + (ext or "folder") + "_list.png",
+        "title": title,
+        "mimeType": mime,
+        "labels": {"starred": rng.random() < 0.1, "hidden": False, "trashed": False,
+                   "restricted": False, "viewed": rng.random() < 0.7},
+        "createdDate": date(),
+        "modifiedDate": date(),
+        "modifiedByMeDate": date(),
+        "lastViewedByMeDate": date(),
+        "markedViewedByMeDate": "1970-01-01T00:00:00.000Z",
+        "version": str(rng.randint(1000, 900000)),
+        "parents": [{"kind": "drive#parentReference", "id": parent,
+                     "selfLink": API + "/files/" + fid + "/parents/" + parent,
+                     "parentLink": API + "/files/" + parent, "isRoot": rng.random() < 0.2}],
+        "userPermission": {"kind": "drive#permission", "etag": "\"Hx5cT8mYtPLqbHUAQXxeQvxbqTg/abc\"",
+                           "id": "me", "selfLink": API + "/files/" + fid + "/permissions/me",
+                           "role": "owner", "type": "user"},
+        "quotaBytesUsed": "0",
+        "ownerNames": [owner[0]],
+        "owners": [user(owner)],
+        "lastModifyingUserName": owner[0],
+        "lastModifyingUser": user(owner),
+        "editable": True,
+        "copyable": True,
+        "writersCanShare": True,
+        "shared": rng.random() < 0.3,
+        "explicitlyTrashed": False,
+        "appDataContents": False,
+        "spaces": ["drive"],
+    }
+    if ext:
+        size = rng.randint(100, 50000000)
+        item.update({
+            "webContentLink": "https://docs.google.com/uc?id=" + fid + "&export=download",
+            "downloadUrl": "https://doc-0s-9c-docs.googleusercontent.com/docs/securesc/x/" + fid + "?e=download&gd=true",
+            "originalFilename": title,
+            "fileExtension": ext,
+            "md5Checksum": "%032x" % rng.getrandbits(128),
+            "fileSize": str(size),
+            "quotaBytesUsed": str(size),
+            "headRevisionId": "0B" + "".join(rng.choice(ALPHABET) for _ in range(40)),
+        })
+        if ext == "jpg":
+            item["imageMediaMetadata"] = {"width": 4032, "height": 3024, "rotation": 0,
+                                          "date": "2014:06:01 12:30:00", "cameraMake": "Apple",
+                                          "cameraModel": "iPhone 5s", "exposureTime": 0.008,
+                                          "aperture": 2.2, "flashUsed": False, "focalLength": 4.15,
+                                          "isoSpeed": 32, "location": {"latitude": 37.42,
+                                                                      "longitude": -122.08,
+                                                                      "altitude": 12.5}}
+    elif mime != "application/vnd.google-apps.folder":
+        item["exportLinks"] = {
+            "application/pdf": "https://docs.google.com/feeds/download/documents/export/Export?id=" + fid + "&exportFormat=pdf",
+            "text/plain": "https://docs.google.com/feeds/download/documents/export/Export?id=" + fid + "&exportFormat=txt",
+        }
+    return item
+
+
+def write(name, value):
+    with open(os.path.join(HERE, name), "w", encoding="utf-8") as out:
+        json.dump(value, out, ensure_ascii=False, indent=1)
+        out.write("\n")
+
+
+write("file_list.json", {
+    "kind": "drive#fileList",
+    "etag": "\"Hx5cT8mYtPLqbHUAQXxeQvxbqTg/vyGp6PvFo4RvsFtPoIWeCReyIC8\"",
+    "selfLink": API + "/files?maxResults=1000",
+    "nextPageToken": "EAIaggELEgA6XAoI0ZLL4dPU",
+    "nextLink": API + "/files?maxResults=1000&pageToken=EAIaggELEgA6XAoI0ZLL4dPU",
+    "items": [gfile() for _ in range(1000)],
+})
+
+changes = []
+for i in range(500):
+    fid = file_id()
+    change = {"kind": "drive#change", "id": str(7400000 + i), "fileId": fid,
+              "selfLink": API + "/changes/" + str(7400000 + i), "deleted": rng.random() < 0.1,
+              "modificationDate": date()}
+    if not change["deleted"]:
+        change["file"] = gfile()
+        change["fileId"] = change["file"]["id"]
+    changes.append(change)
+write("change_list.json", {
+    "kind": "drive#changeList",
+    "etag": "\"Hx5cT8mYtPLqbHUAQXxeQvxbqTg/d2VWdKlQ5vZzjAAmlMTEP2EfHv0\"",
+    "selfLink": API + "/changes?startChangeId=7400000",
+    "nextPageToken": "7400500",
+    "nextLink": API + "/changes?pageToken=7400500",
+    "largestChangeId": "7412345",
+    "items": changes,
+})
+
+formats = ["application/pdf", "text/plain", "text/html", "application/rtf",
+           "application/vnd.oasis.opendocument.text", "image/jpeg", "image/png",
+           "application/vnd.openxmlformats-officedocument.wordprocessingml.document"]
+write("about.json", {
+    "kind": "drive#about",
+    "etag": "\"Hx5cT8mYtPLqbHUAQXxeQvxbqTg/f3gKHI8Vh3iWPrdZ5O2rv4sb1Hs\"",
+    "selfLink": API + "/about",
+    "name": OWNERS[0][0],
+    "user": user(OWNERS[0]),
+    "quotaBytesTotal": "16106127360",
+    "quotaBytesUsed": "4394021212",
+    "quotaBytesUsedAggregate": "5013249216",
+    "quotaBytesUsedInTrash": "1238771",
+    "quotaType": "LIMITED",
+    "quotaBytesByService": [{"serviceName": "DRIVE", "bytesUsed": "4394021212"},
+                            {"serviceName": "GMAIL", "bytesUsed": "612000123"},
+                            {"serviceName": "PHOTOS", "bytesUsed": "7227881"}],
+    "largestChangeId": "7412345",
+    "remainingChangeIds": "0",
+    "rootFolderId": "0AGz4hQmSXbCMUk9PVA",
+    "domainSharingPolicy": "allowed",
+    "permissionId": OWNERS[0][2],
+    "importFormats": [{"source": s, "targets": ["application/vnd.google-apps.document"]} for s in formats],
+    "exportFormats": [{"source": "application/vnd.google-apps.document", "targets": formats},
+                      {"source": "application/vnd.google-apps.spreadsheet", "targets": formats[:4]}],
+    "additionalRoleInfo": [{"type": "application/vnd.google-apps.document",
+                            "roleSets": [{"primaryRole": "reader", "additionalRoles": ["commenter"]}]}],
+    "features": [{"featureName": "ocr", "featureRate": 2.0}, {"featureName": "translation", "featureRate": 2.0}],
+    "maxUploadSizes": [{"type": "application/vnd.google-apps.document", "size": "10485760"},
+                       {"type": "*", "size": "5242880000000"}],
+    "isCurrentAppInstalled": False,
+    "languageCode": "en",
+})
+
+write("error_404.json", {"error": {"errors": [{"domain": "global", "reason": "notFound",
+                                               "message": "File not found: 0B1234", "locationType": "other",
+                                               "location": "file"}],
+                                   "code": 404, "message": "File not found: 0B1234"}})
+write("error_403.json", {"error": {"errors": [{"domain": "usageLimits", "reason": "userRateLimitExceeded",
+                                               "message": "User Rate Limit Exceeded"}],
+                                   "code": 403, "message": "User Rate Limit Exceeded"}})
+write("error_401.json", {"error": {"errors": [{"domain": "global", "reason": "authError",
+                                               "message": "Invalid Credentials", "locationType": "header",
+                                               "location": "Authorization"}],
+                                   "code": 401, "message": "Invalid Credentials"}})
+
+# the header blocks of a resumable upload chunk: a 100 Continue and the 308
+with open(os.path.join(HERE, "upload_headers.txt"), "w", newline="") as out:
+    out.write("HTTP/1.1 100 Continue\r\n\r\n")
+    out.write("HTTP/1.1 308 Resume Incomplete\r\n"
+              "X-GUploader-UploadID: AEnB2UpM3QmQw9xF0qnB7h1o5cJcK3l4vX2mY8sZ0aT6rE1uW9iO3pL5kJ7hG2fD4sA6qZ8xC0vB\r\n"
+              "Range: bytes=0-262143\r\n"
+              "X-Range-MD5: 8a7d0e2f9c1b3a4d5e6f708192a3b4c5\r\n"
+              "Content-Length: 0\r\n"
+              "Date: Sun, 19 Oct 2014 18:51:02 GMT\r\n"
+              "Server: UploadServer\r\n"
+              "Content-Type: text/html; charset=UTF-8\r\n"
+              "Alternate-Protocol: 443:quic,p=0.01\r\n"
+              "Cache-Control: no-cache, no-store, max-age=0, must-revalidate\r\n"
+              "Pragma: no-cache\r\n"
+              "Expires: Mon, 01 Jan 1990 00:00:00 GMT\r\n"
+              "Vary: Origin\r\n"
+              "Vary: X-Origin\r\n"
+              "\r\n")
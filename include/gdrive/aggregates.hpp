@@ -0,0 +1,64 @@
+#ifndef __GDRIVE_AGGREGATES_HPP__
+#define __GDRIVE_AGGREGATES_HPP__
+
+#include "gdrive/config.hpp"
+#include "gdrive/gitem.hpp"
+#include "gdrive/dirgraph.hpp"
+#include "common/all.hpp"
+
+#include <string>
+#include <vector>
+
+namespace GDRIVE {
+
+class FolderTotals {
+public:
+    FolderTotals();
+    long long files;
+    long long folders;
+    long long bytes;
+    long long quota_bytes;
+
+    FolderTotals& operator+=(const FolderTotals& other);
+    FolderTotals& operator-=(const FolderTotals& other);
+};
+
+/*
+ * Recursive byte and file counts for every folder of a DirectoryGraph.
+ *
+ * Each update removes the old contribution of a file (or of a whole folder
+ * subtree) from its ancestors and adds the new one, so listings may arrive in
+ * any order and a move costs one walk up each side instead of a recrawl.
+ * A file reachable through two parents is counted once per ancestor, except
+ * when the two paths meet again higher up through separately added folders.
+ */
+class FolderAggregates {
+    CLASS_MAKE_LOGGER
+    public:
+        FolderAggregates();
+
+        void add(GFile& file);
+        void add(std::vector<GFile>& files);
+        void remove(const std::string& id);
+        void apply(GChange& change);
+        void apply(std::vector<GChange>& changes);
+
+        // totals below a folder, not counting the folder itself
+        FolderTotals totals(const std::string& id) const;
+        FolderTotals totals(NodeIndex node) const;
+
+        inline DirectoryGraph& graph() { return _graph; }
+        void clear();
+    private:
+        FolderTotals _contribution(NodeIndex node) const;
+        void _propagate(NodeIndex node, const FolderTotals& delta, bool add);
+        void _ensure(size_t size);
+
+        DirectoryGraph _graph;
+        std::vector<FolderTotals> _own;
+        std::vector<FolderTotals> _totals;
+};
+
+}
+
+#endif
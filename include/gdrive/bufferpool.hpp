@@ -0,0 +1,54 @@
+#ifndef __GDRIVE_BUFFERPOOL_HPP__
+#define __GDRIVE_BUFFERPOOL_HPP__
+
+#include "common/all.hpp"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#define BUFFER_POOL_MIN_BUFFER 4096
+#define BUFFER_POOL_MAX_BUFFERS 64
+#define BUFFER_POOL_MAX_RETAINED (32 << 20)
+
+namespace GDRIVE {
+
+/*
+ * Spare string storage shared by requests. acquire() hands a cleared
+ * buffer with room for at least size bytes, taking the smallest pooled
+ * buffer that fits before allocating; release() takes the storage of a
+ * buffer back once its owner is done with it.
+ *
+ * Buffers under BUFFER_POOL_MIN_BUFFER are not worth keeping, and a
+ * release that would push the pool over max_retained bytes frees the
+ * buffer instead. Safe to use from several threads.
+ */
+class BufferPool {
+    CLASS_MAKE_LOGGER
+    public:
+        BufferPool(size_t max_retained = BUFFER_POOL_MAX_RETAINED);
+        ~BufferPool();
+
+        void acquire(std::string& buffer, size_t size);
+        void release(std::string& buffer);
+
+        // bytes and buffers kept for reuse right now
+        size_t retained();
+        size_t size();
+
+        // the pool requests use unless given another one
+        static BufferPool& shared();
+    private:
+        pthread_mutex_t _lock;
+        std::vector<std::string> _free;
+        size_t _retained;
+        size_t _max_retained;
+
+        BufferPool(const BufferPool& other);
+        BufferPool& operator=(const BufferPool& other);
+};
+
+}
+
+#endif
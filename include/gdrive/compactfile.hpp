@@ -0,0 +1,155 @@
+#ifndef __GDRIVE_COMPACTFILE_HPP__
+#define __GDRIVE_COMPACTFILE_HPP__
+
+#include "gdrive/gitem.hpp"
+#include "gdrive/lazyfile.hpp"
+#include "common/all.hpp"
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GDRIVE {
+
+/*
+ * Keeps one copy of every distinct string handed to it and names it by a
+ * 32 bit id. Id 0 is always the empty string. Strings are never released,
+ * so a pool should be shared by the files of one crawl and dropped with
+ * them. Not thread safe.
+ */
+class StringPool {
+    public:
+        typedef uint32_t Id;
+
+        StringPool();
+
+        Id intern(const std::string& value);
+        inline const std::string& get(Id id) const { return *_strings[id]; }
+        inline size_t size() const { return _strings.size(); }
+        // bytes held by the pool, see CompactFile::memory_usage()
+        size_t memory_usage() const;
+    private:
+        std::map<std::string, Id> _index;
+        std::vector<const std::string*> _strings;
+
+        StringPool(const StringPool& other);
+        StringPool& operator=(const StringPool& other);
+};
+
+/*
+ * A GFile packed for holding millions of files in memory.
+ *
+ * Fields a crawler looks at stay inline: id and title as strings, values
+ * that repeat across files (mimeType, iconLink, fileExtension, owner
+ * names, parent ids) as StringPool ids, dates as milliseconds since the
+ * epoch, md5Checksum as 16 raw bytes and the boolean fields as bits. The
+ * self and parent links of parents are not kept, they are API urls built
+ * from the ids.
+ *
+ * Every other field the file carries is written as JSON into one side
+ * allocation and read back on demand through rare(). Files decoded with a
+ * GFileProjection that sticks to the inline fields never make it.
+ */
+class CompactFile {
+public:
+    CompactFile();
+    CompactFile(const GFile& file, StringPool& pool);
+    CompactFile(const CompactFile& other);
+    CompactFile& operator=(const CompactFile& other);
+    ~CompactFile();
+
+    GFile to_gfile() const;
+
+    inline const std::string& get_id() const { return _id; }
+    inline const std::string& get_title() const { return _title; }
+    inline const std::string& get_mimeType() const { return _pool->get(_mimeType); }
+    inline const std::string& get_iconLink() const { return _pool->get(_iconLink); }
+    inline const std::string& get_fileExtension() const { return _pool->get(_fileExtension); }
+    inline const std::string& get_lastModifyingUserName() const { return _pool->get(_lastModifyingUserName); }
+    std::string get_md5Checksum() const;
+    inline long long get_fileSize() const { return _fileSize; }
+    inline long long get_quotaBytesUsed() const { return _quotaBytesUsed; }
+
+    inline size_t parent_count() const { return _parents.size(); }
+    inline const std::string& get_parent_id(size_t i) const { return _pool->get(_parents[i]); }
+    inline bool get_parent_isRoot(size_t i) const { return (_root_parents & (1U << i)) != 0; }
+    inline size_t owner_count() const { return _ownerNames.size(); }
+    inline const std::string& get_ownerName(size_t i) const { return _pool->get(_ownerNames[i]); }
+
+    inline long long get_createdDate_ms() const { return _createdDate; }
+    inline long long get_modifiedDate_ms() const { return _modifiedDate; }
+    inline long long get_modifiedByMeDate_ms() const { return _modifiedByMeDate; }
+    inline long long get_lastViewedByMeDate_ms() const { return _lastViewedByMeDate; }
+    inline long long get_sharedWithMeDate_ms() const { return _sharedWithMeDate; }
+
+    inline bool get_starred() const { return _flag(STARRED); }
+    inline bool get_hidden() const { return _flag(HIDDEN); }
+    inline bool get_trashed() const { return _flag(TRASHED); }
+    inline bool get_restricted() const { return _flag(RESTRICTED); }
+    inline bool get_viewed() const { return _flag(VIEWED); }
+    inline bool get_editable() const { return _flag(EDITABLE); }
+    inline bool get_copyable() const { return _flag(COPYABLE); }
+    inline bool get_writersCanShare() const { return _flag(WRITERS_CAN_SHARE); }
+    inline bool get_shared() const { return _flag(SHARED); }
+    inline bool get_explicitlyTrashed() const { return _flag(EXPLICITLY_TRASHED); }
+    inline bool get_appDataContents() const { return _flag(APP_DATA_CONTENTS); }
+
+    // the fields stored out of line, empty when the file had none of them
+    const LazyGFile& rare() const;
+    inline bool has_rare() const { return _rare != NULL; }
+
+    /*
+     * Bytes owned by this object: the object itself, the heap buffers of
+     * its strings and vectors and the out of line fields. Strings behind
+     * pool ids are counted once by StringPool::memory_usage(). Heap sizes
+     * are taken from capacities, allocator overhead is not included.
+     */
+    size_t memory_usage() const;
+
+    // the fields a CompactFile holds inline, for building a projection
+    static FieldMask inline_fields();
+private:
+    enum Flag {
+        STARRED = 1 << 0,
+        HIDDEN = 1 << 1,
+        TRASHED = 1 << 2,
+        RESTRICTED = 1 << 3,
+        VIEWED = 1 << 4,
+        EDITABLE = 1 << 5,
+        COPYABLE = 1 << 6,
+        WRITERS_CAN_SHARE = 1 << 7,
+        SHARED = 1 << 8,
+        EXPLICITLY_TRASHED = 1 << 9,
+        APP_DATA_CONTENTS = 1 << 10,
+        HAS_MD5 = 1 << 11
+    };
+
+    std::string _id;
+    std::string _title;
+    long long _fileSize;
+    long long _quotaBytesUsed;
+    long long _createdDate;
+    long long _modifiedDate;
+    long long _modifiedByMeDate;
+    long long _lastViewedByMeDate;
+    long long _sharedWithMeDate;
+    std::vector<StringPool::Id> _parents;
+    std::vector<StringPool::Id> _ownerNames;
+    const StringPool* _pool;
+    LazyGFile* _rare;
+    StringPool::Id _mimeType;
+    StringPool::Id _iconLink;
+    StringPool::Id _fileExtension;
+    StringPool::Id _lastModifyingUserName;
+    uint32_t _root_parents;
+    uint16_t _flags;
+    unsigned char _md5[16];
+
+    inline bool _flag(Flag flag) const { return (_flags & flag) != 0; }
+    inline void _set_flag(Flag flag, bool value) { if (value) _flags |= flag; }
+};
+
+}
+
+#endif
@@ -13,4 +13,7 @@
 
 #define SERVICE_URI "https://www.googleapis.com/drive/v2"
 #define FILE_UPLOAD_URL "https://www.googleapis.com/upload/drive/v2/files"
+
+#define FOLDER_MIMETYPE "application/vnd.google-apps.folder"
+#define ROOT_FOLDER_ALIAS "root"
 #endif
@@ -42,12 +42,14 @@ class CredentialHttpRequest : public HttpRequest {
     CLASS_MAKE_LOGGER
     public:
         CredentialHttpRequest(Credential *cred, std::string uri, RequestMethod method);
-        HttpResponse request();
+        HttpResponse& request();
     protected:
         Credential *_cred;
 
         void _apply_header();
         void _refresh();
+        // a transfer started at begin, 0 when not traced
+        void _record_transfer(long long begin, int status, const TransferTiming& timing);
 
         std::string _generate_request_body();
         RequestHeader _generate_request_header();
@@ -0,0 +1,57 @@
+#ifndef __GDRIVE_DECODEPOOL_HPP__
+#define __GDRIVE_DECODEPOOL_HPP__
+
+#include "common/all.hpp"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <vector>
+
+namespace GDRIVE {
+
+/*
+ * A fixed set of worker threads for splitting one decoding job across
+ * cores. run() cuts [0, count) into slices of grain items, lets the
+ * workers and the calling thread pull slices until none are left and
+ * returns once every slice is done. The threads are started once and
+ * reused, so a pool should live as long as the crawler using it.
+ *
+ * Tasks must not throw. Concurrent run() calls are serialized.
+ */
+class DecodePool {
+    CLASS_MAKE_LOGGER
+    public:
+        typedef void (*Task)(void* context, size_t begin, size_t end);
+
+        // workers <= 0 uses one worker per online core besides the caller
+        DecodePool(int workers = 0);
+        ~DecodePool();
+
+        void run(Task task, void* context, size_t count, size_t grain);
+        inline int concurrency() const { return _threads.size() + 1; }
+    private:
+        std::vector<pthread_t> _threads;
+        pthread_mutex_t _run_lock;
+        pthread_mutex_t _lock;
+        pthread_cond_t _wake;
+        pthread_cond_t _done;
+
+        Task _task;
+        void* _context;
+        size_t _count;
+        size_t _grain;
+        size_t _next;
+        int _active;
+        unsigned long _generation;
+        bool _stop;
+
+        void _drain();
+        static void* _worker(void* self);
+
+        DecodePool(const DecodePool& other);
+        DecodePool& operator=(const DecodePool& other);
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef __GDRIVE_DIRGRAPH_HPP__
+#define __GDRIVE_DIRGRAPH_HPP__
+
+#include "gdrive/config.hpp"
+#include "gdrive/gitem.hpp"
+#include "common/all.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace GDRIVE {
+
+typedef uint32_t NodeIndex;
+typedef uint32_t EdgeIndex;
+
+#define INVALID_NODE ((NodeIndex)-1)
+#define INVALID_EDGE ((EdgeIndex)-1)
+
+enum NodeFlag {
+    NF_KNOWN   = 1,   // metadata for this node has been seen
+    NF_FOLDER  = 2,
+    NF_ROOT    = 4,
+    NF_REMOVED = 8
+};
+
+/*
+ * Parent/child graph of a drive with every file id interned once and mapped
+ * to a dense NodeIndex. Edges live in flat arrays and are threaded through
+ * two intrusive lists, one per parent (its children) and one per child (its
+ * parents), so a node costs a few words instead of a GFile's parent vector.
+ *
+ * Files may have several parents and the server does not promise a DAG, so
+ * every traversal keeps a visited set and terminates on cycles.
+ *
+ * Nodes are never reclaimed. A removed node keeps its index, id and title,
+ * so the NodeIndex values callers hold stay valid and an untrashed folder
+ * finds its children again; only its parent edges are freed for reuse.
+ * clear() drops everything.
+ */
+class DirectoryGraph {
+    CLASS_MAKE_LOGGER
+    public:
+        DirectoryGraph();
+
+        NodeIndex intern(const std::string& id);
+        NodeIndex find(const std::string& id) const;
+
+        NodeIndex add(GFile& file);
+        void add(std::vector<GFile>& files);
+        void set_parents(NodeIndex node, const std::vector<NodeIndex>& parents);
+        void remove(const std::string& id);
+        void apply(GChange& change);
+        void apply(std::vector<GChange>& changes);
+
+        inline size_t size() const { return _ids.size(); }
+        inline const std::string& id(NodeIndex node) const { return _ids[node]; }
+        inline const std::string& title(NodeIndex node) const { return _titles[node]; }
+        inline bool is_folder(NodeIndex node) const { return (_flags[node] & NF_FOLDER) != 0; }
+        inline bool is_root(NodeIndex node) const { return (_flags[node] & NF_ROOT) != 0; }
+        inline bool is_removed(NodeIndex node) const { return (_flags[node] & NF_REMOVED) != 0; }
+
+        std::vector<NodeIndex> parents(NodeIndex node) const;
+        std::vector<NodeIndex> children(NodeIndex node) const;
+        std::vector<NodeIndex> ancestors(NodeIndex node) const;
+        std::vector<NodeIndex> subtree(NodeIndex node) const;
+        /*
+         * The shortest chain of parents up to a root, the first listed
+         * parent winning a tie. "" when no chain reaches one.
+         */
+        std::string path(NodeIndex node) const;
+
+        size_t memory_usage() const;
+        void clear();
+    private:
+        struct Edge {
+            NodeIndex parent;
+            NodeIndex child;
+            EdgeIndex prev_child, next_child;    // edges with the same parent
+            EdgeIndex prev_parent, next_parent;  // edges with the same child
+        };
+
+        void _unlink_parents(NodeIndex node);
+        void _unlink(EdgeIndex edge);
+        EdgeIndex _new_edge();
+
+        std::unordered_map<std::string, NodeIndex> _index;
+        std::vector<std::string> _ids;
+        std::vector<std::string> _titles;
+        std::vector<uint8_t> _flags;
+        std::vector<EdgeIndex> _first_child;
+        std::vector<EdgeIndex> _first_parent;
+
+        std::vector<Edge> _edges;
+        EdgeIndex _free_edge;
+};
+
+}
+
+#endif
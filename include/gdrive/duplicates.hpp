@@ -0,0 +1,82 @@
+#ifndef __GDRIVE_DUPLICATES_HPP__
+#define __GDRIVE_DUPLICATES_HPP__
+
+#include "gdrive/config.hpp"
+#include "gdrive/credential.hpp"
+#include "gdrive/servicerequest.hpp"
+#include "gdrive/gitem.hpp"
+#include "common/all.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// the only file fields the index looks at, used to narrow listings
+#define DUPLICATE_FIELDS "nextPageToken,items(id,md5Checksum,fileSize,labels/trashed)"
+
+namespace GDRIVE {
+
+class DuplicateGroup {
+public:
+    DuplicateGroup();
+    std::string md5Checksum;
+    long fileSize;
+    std::vector<std::string> ids;
+
+    // bytes freed by keeping a single copy
+    inline long long reclaimable() const { return (long long)fileSize * (ids.size() - 1); }
+};
+
+/*
+ * Hash index from (md5Checksum, fileSize) to file ids. Checksums are kept as
+ * 128-bit binary keys, so a million entries cost little more than their ids.
+ * Files without a checksum (folders, Google documents) and trashed files are
+ * ignored.
+ */
+class DuplicateIndex {
+    CLASS_MAKE_LOGGER
+    public:
+        DuplicateIndex();
+
+        void add(GFile& file);
+        void add(std::vector<GFile>& files);
+        void remove(const std::string& id);
+        void apply(GChange& change);
+        void apply(std::vector<GChange>& changes);
+
+        // streams every page of files.list through the index, one page in memory at a time
+        void build(Credential* cred);
+        static void narrow(FileListRequest& list);
+
+        // groups of at least two files, largest reclaimable bytes first
+        std::vector<DuplicateGroup> groups() const;
+        long long reclaimable() const;
+
+        inline size_t size() const { return _keys.size(); }
+        void clear();
+    private:
+        struct Key {
+            uint64_t hi;
+            uint64_t lo;
+            long size;
+            bool operator==(const Key& other) const {
+                return hi == other.hi && lo == other.lo && size == other.size;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return (size_t)(key.hi ^ (key.lo * 31) ^ (uint64_t)key.size);
+            }
+        };
+
+        static bool _make_key(const std::string& md5, long size, Key& key);
+        static std::string _md5_string(const Key& key);
+
+        std::unordered_map<Key, std::vector<std::string>, KeyHash> _groups;
+        std::unordered_map<std::string, Key> _keys;
+};
+
+}
+
+#endif
@@ -6,37 +6,68 @@
 #include <exception>
 
 #include "gdrive/gitem.hpp"
+#include "gdrive/request.hpp"
 
 namespace GDRIVE {
 
 class GoogleJsonResponseException : public std::exception {
     public:
-        GoogleJsonResponseException(GError error)
-            :_details(error)
+        GoogleJsonResponseException(GError error, const TransferTiming& timing = TransferTiming())
+            :_details(error), _timing(timing)
         {
         }
 
         GError& details() {
             return _details;
         }
+        // of the transfer that got the error response
+        const TransferTiming& timing() const { return _timing; }
 
         virtual ~GoogleJsonResponseException() throw() {}
 
     private:
         GError _details;
+        TransferTiming _timing;
 };
 
 
 class CurlException : public std::exception {
     public:
-        CurlException(int code, std::string error)
-            :_code(code), _error(error) {}
+        CurlException(int code, std::string error, const TransferTiming& timing = TransferTiming())
+            :_code(code), _error(error), _timing(timing) {}
         std::string error() { return _error; }
         int code() { return _code;}
+        // how far the failed transfer got, e.g. connect is 0 when DNS failed
+        const TransferTiming& timing() const { return _timing; }
         virtual ~CurlException() throw() {}
     private:
         std::string _error;
         int _code;
+        TransferTiming _timing;
+};
+
+class JsonParseException : public std::exception {
+    public:
+        JsonParseException(std::string error, int position)
+            :_error(error), _position(position) {}
+        std::string error() { return _error; }
+        int position() { return _position; }
+        virtual ~JsonParseException() throw() {}
+    private:
+        std::string _error;
+        int _position;
+};
+
+class QueryException : public std::exception {
+    public:
+        QueryException(std::string error, int position)
+            :_error(error), _position(position) {}
+        std::string error() { return _error; }
+        int position() { return _position; }
+        virtual ~QueryException() throw() {}
+    private:
+        std::string _error;
+        int _position;
 };
 
 
@@ -6,8 +6,22 @@
 #include "gdrive/drive.hpp"
 #include "gdrive/filecontent.hpp"
 #include "gdrive/gitem.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/jsonwriter.hpp"
+#include "gdrive/lazyfile.hpp"
+#include "gdrive/log.hpp"
+#include "gdrive/compactfile.hpp"
+#include "gdrive/decodepool.hpp"
+#include "gdrive/bufferpool.hpp"
 #include "gdrive/oauth.hpp"
+#include "gdrive/pathindex.hpp"
+#include "gdrive/dirgraph.hpp"
+#include "gdrive/aggregates.hpp"
+#include "gdrive/duplicates.hpp"
+#include "gdrive/metacache.hpp"
+#include "gdrive/metrics.hpp"
 #include "gdrive/servicerequest.hpp"
 #include "gdrive/store.hpp"
+#include "gdrive/tracer.hpp"
 
 #endif
@@ -9,11 +9,11 @@
 
 #include "jconer/json.hpp"
 
-#define GETTER(type, name) type get_##name() { return name;}
+#define GETTER(type, name) const type& get_##name() const { return name;}
 
 #define SETTER(type, name) void set_##name(type v) {\
     name = v; \
-    _fields.insert(#name); \
+    _fields |= FIELD_BIT(F_##name); \
 }
 
 #define READONLY(type, name) \
@@ -29,14 +29,76 @@
         SETTER(type, name) \
         GETTER(type, name)
 
+// Timestamps are kept as milliseconds since the epoch, 0 when unset, and
+// turned into a struct tm only when the old style getter is called.
+#define READONLY_TIME(name) \
+    private: \
+        long long name; \
+    public: \
+        struct tm get_##name() const { return time_from_epoch_ms(name); } \
+        long long get_##name##_ms() const { return name; }
+
+#define WRITABLE_TIME(name) \
+    READONLY_TIME(name) \
+        void set_##name(struct tm v) { set_##name##_ms(time_to_epoch_ms(v)); } \
+        void set_##name##_ms(long long v) { \
+            name = v; \
+            _fields |= FIELD_BIT(F_##name); \
+        }
+
+
+// Every serializable type numbers its fields through an X-macro list;
+// dirty tracking and partial serialization work on masks of those bits.
+#define FIELD_BIT(field) (1ULL << (field))
+#define ALL_FIELDS (~0ULL)
+
+#define FIELD_ENUM(name) F_##name,
+#define FIELD_NAME(name) #name,
+
+#define FIELD_ENUMERATION(LIST) \
+    public: \
+        enum Field { LIST(FIELD_ENUM) FIELD_COUNT };
+
+#define MODIFIED_FIELDS(LIST) \
+    FIELD_ENUMERATION(LIST) \
+        static const char* const FIELD_NAMES[]; \
+        std::set<std::string> get_modified_fields() { return field_names(_fields, FIELD_NAMES, FIELD_COUNT); } \
+        FieldMask get_modified_mask() { return _fields; } \
+        void clear() { _fields = 0; } \
+    private: \
+        FieldMask _fields; \
+    public:
 
 using namespace JCONER;
 
 namespace GDRIVE {
+
+class JsonReader;
+class JsonWriter;
+
+typedef unsigned long long FieldMask;
+
+std::set<std::string> field_names(FieldMask mask, const char* const names[], int count);
+
+struct tm time_from_string(std::string time_repr);
+std::string time_to_string(struct tm time);
+// milliseconds since the epoch in UTC, 0 stands for an unset time
+long long time_to_epoch_ms(struct tm time);
+struct tm time_from_epoch_ms(long long ms);
+// RFC 3339 as the API writes it, "2014-03-10T10:20:30.123Z" or with a
+// numeric offset. 0 when the value is empty or malformed.
+long long epoch_ms_from_string(const char* data, size_t size);
+long long epoch_ms_from_string(const std::string& repr);
+std::string epoch_ms_to_string(long long ms);
+
 // File representation
 
+#define GFILELABEL_FIELDS(X) \
+    X(starred) X(hidden) X(trashed) X(restricted) X(viewed)
+
 class GFileLabel {
 public:
+    FIELD_ENUMERATION(GFILELABEL_FIELDS)
     GFileLabel();
     bool starred;
     bool hidden;
@@ -44,35 +106,43 @@ public:
     bool restricted;
     bool viewed;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
+#define GUSER_FIELDS(X) \
+    X(displayName) X(isAuthenticatedUser) X(permissionId) X(picture)
+
 class GUser {
 public:
+    FIELD_ENUMERATION(GUSER_FIELDS)
     GUser();
     std::string displayName;
     std::string picture_url;
     bool isAuthenticatedUser;
     std::string permissionId;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
+#define GPARENT_FIELDS(X) \
+    X(id) X(selfLink) X(parentLink) X(isRoot)
+
 class GParent {
 public:
+    MODIFIED_FIELDS(GPARENT_FIELDS)
     GParent();
     WRITABLE(std::string, id)
     READONLY(std::string, selfLink)
     READONLY(std::string, parentLink)
     READONLY(bool, isRoot)
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
-
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
-
-private:
-    std::set<std::string> _fields;
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
 
@@ -80,13 +150,18 @@ class GParentList {
 public:
     GParentList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
     READONLY(std::vector<GParent>, items)
 };
 
+#define GPROPERTY_FIELDS(X) \
+    X(etag) X(selfLink) X(key) X(value) X(visibility)
+
 class GProperty {
 public:
+    FIELD_ENUMERATION(GPROPERTY_FIELDS)
     GProperty();
     std::string etag;
     std::string selfLink;
@@ -94,15 +169,20 @@ public:
     std::string visibility;
     std::string value;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
+#define GPERMISSION_FIELDS(X) \
+    X(etag) X(id) X(selfLink) X(name) X(emailAddress) X(domain) X(role) X(additionalRoles) \
+    X(type) X(value) X(authKey) X(withLink) X(photoLink)
+
 class GPermission {
 public:
+    MODIFIED_FIELDS(GPERMISSION_FIELDS)
     GPermission();
 
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
 
     READONLY(std::string, etag)
     WRITABLE(std::string, id)
@@ -119,9 +199,9 @@ public:
     READONLY(std::string, photoLink)
 
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
-private:
-    std::set<std::string> _fields;
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
 class GPermissionId {
@@ -130,6 +210,7 @@ public:
         id = "";
     }
     void from_json(JObject *);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, id);
 };
@@ -138,25 +219,39 @@ class GPermissionList {
 public:
     GPermissionList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
     READONLY(std::vector<GPermission>, items)
 };
 
+#define GIMAGEMEDIAMETADATA_LOCATION_FIELDS(X) \
+    X(latitude) X(longitude) X(altitude)
+
+#define GIMAGEMEDIAMETADATA_FIELDS(X) \
+    X(width) X(height) X(rotation) X(location) X(date) X(cameraMaker) X(cameraModel) \
+    X(exposureTime) X(aperture) X(flashUsed) X(focalLength) X(isoSpeed) X(meteringMode) \
+    X(sensor) X(exposureMode) X(colorSpace) X(whiteBalance) X(exposureBias) X(maxApertureValue) \
+    X(subjectDistance) X(lens)
+
 class GImageMediaMetaData {
 public:
+    FIELD_ENUMERATION(GIMAGEMEDIAMETADATA_FIELDS)
     GImageMediaMetaData();
     int width;
     int height;
     int rotation;
     class Location {
     public:
+        FIELD_ENUMERATION(GIMAGEMEDIAMETADATA_LOCATION_FIELDS)
         double latitude;
         double longitude;
         double altitude;
         void from_json(JObject* obj);
+        void from_json(JsonReader& reader);
         JObject* to_json();
+        void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
     } location;
     std::string date;
     std::string cameraMaker;
@@ -176,20 +271,72 @@ public:
     int subjectDistance;
     std::string lens;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 };
 
 typedef std::map<std::string, std::string> GExportLink;
 typedef std::map<std::string, std::string> Links;
 typedef std::map<std::string, std::string> string_map;
 
+#define GFILE_FIELDS(X) \
+    X(id) X(etag) X(selfLink) X(webContentLink) X(alternateLink) X(embedLink) \
+    X(defaultOpenWithLink) X(openWithLinks) X(iconLink) X(thumbnailLink) \
+    X(title) X(mimeType) X(description) X(labels) \
+    X(createdDate) X(modifiedDate) X(modifiedByMeDate) X(lastViewedByMeDate) X(sharedWithMeDate) \
+    X(version) X(sharingUser) X(parents) X(exportLinks) X(downloadUrl) X(indexableText) \
+    X(userPermission) X(permissions) X(originalFilename) X(fileExtension) X(md5Checksum) \
+    X(fileSize) X(quotaBytesUsed) X(ownerNames) X(owners) X(lastModifyingUserName) \
+    X(lastModifyingUser) X(editable) X(copyable) X(writersCanShare) X(shared) \
+    X(explicitlyTrashed) X(appDataContents) X(headRevisionId) X(properties) X(imageMediaMetadata)
+
+#define GFILE_FIELD_ENUM(name) GF_##name,
+
+enum GFileField {
+    GFILE_FIELDS(GFILE_FIELD_ENUM)
+    GF_FIELD_COUNT
+};
+
+#define GFILE_ALL_FIELDS (FIELD_BIT(GF_FIELD_COUNT) - 1)
+
+/*
+ * The set of GFile fields a caller needs. It renders the fields parameter
+ * so the server only sends those, and the mask it carries makes the parser
+ * skip anything else that still shows up.
+ *
+ *   GFileProjection p;
+ *   p.add(GF_id).add(GF_title).add(GF_parents).add(GF_md5Checksum);
+ */
+class GFileProjection {
+public:
+    GFileProjection() :_mask(0) {}
+    GFileProjection(FieldMask mask) :_mask(mask) {}
+
+    inline GFileProjection& add(GFileField field) { _mask |= FIELD_BIT(field); return *this; }
+    inline bool contains(GFileField field) const { return (_mask & FIELD_BIT(field)) != 0; }
+    inline FieldMask mask() const { return _mask; }
+
+    // "id,title" for files.get, "nextPageToken,items(id,title)" for files.list
+    std::string to_fields() const;
+    std::string to_list_fields() const;
+
+    static const char* name(GFileField field);
+    // -1 when the key is not a GFile field
+    static int field(const std::string& name);
+private:
+    FieldMask _mask;
+};
+
 class GFile {
 public:
+    MODIFIED_FIELDS(GFILE_FIELDS)
     GFile();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
+    void from_json(JsonReader& reader, FieldMask projection);
     JObject* to_json();
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
     
 
     READONLY(std::string, id)
@@ -207,11 +354,11 @@ public:
     WRITABLE(std::string, mimeType)
     WRITABLE(std::string, description)
     WRITABLE(GFileLabel, labels)
-    READONLY(struct tm, createdDate)
-    WRITABLE(struct tm, modifiedDate)
-    READONLY(struct tm, modifiedByMeDate)
-    READONLY(struct tm, lastViewedByMeDate)
-    READONLY(struct tm, sharedWithMeDate)
+    READONLY_TIME(createdDate)
+    WRITABLE_TIME(modifiedDate)
+    READONLY_TIME(modifiedByMeDate)
+    READONLY_TIME(lastViewedByMeDate)
+    READONLY_TIME(sharedWithMeDate)
     READONLY(std::string, version)
     READONLY(GUser, sharingUser)
     WRITABLE(std::vector<GParent>, parents)
@@ -238,8 +385,6 @@ public:
     READONLY(std::vector<GProperty>, properties)
     READONLY(GImageMediaMetaData, imageMediaMetadata)
     WRITABLE(bool, writersCanShare)
-private:
-    std::set<std::string> _fields;
 };
 
 
@@ -247,6 +392,9 @@ class GFileList {
 public:
     GFileList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
+    void from_json(JsonReader& reader, FieldMask projection);
+    void swap_items(std::vector<GFile>& other) { items.swap(other); }
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -263,6 +411,7 @@ public:
     std::string serviceName;
     long bytesUsed;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 class GFormat {
@@ -271,6 +420,7 @@ public:
     std::string source;
     std::vector<std::string> targets;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 class GRole {
@@ -279,6 +429,7 @@ public:
     std::string primaryRole;
     std::vector<std::string> additionalRoles;
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 class GRoleInfo {
@@ -288,6 +439,7 @@ public:
     std::vector<GRole> roleSets;
 
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 class GFeature {
@@ -297,6 +449,7 @@ public:
     double featureRate;
 
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 
@@ -307,12 +460,14 @@ public:
     long size;
 
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 };
 
 class GAbout {
 public:
     GAbout();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -343,6 +498,7 @@ class GChange {
 public:
     GChange();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, id)
     READONLY(std::string, fileId)
@@ -356,6 +512,8 @@ class GChangeList {
 public:
     GChangeList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
+    void swap_items(std::vector<GChange>& other) { items.swap(other); }
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -366,26 +524,30 @@ public:
 };
 
 // Children representation
+#define GCHILDREN_FIELDS(X) \
+    X(id) X(selfLink) X(childLink)
+
 class GChildren {
 public:
+    MODIFIED_FIELDS(GCHILDREN_FIELDS)
     GChildren();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
 
     WRITABLE(std::string, id)
     READONLY(std::string, selfLink)
     READONLY(std::string, childLink)
-private:
-    std::set<std::string> _fields;
 };
 
 class GChildrenList {
 public:
     GChildrenList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
+    void swap_items(std::vector<GChildren>& other) { items.swap(other); }
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -396,14 +558,20 @@ public:
 
 
 // Revision representation
+#define GREVISION_FIELDS(X) \
+    X(etag) X(id) X(selfLink) X(mimeType) X(modifiedDate) X(pinned) X(published) \
+    X(publishedLink) X(publishedAuto) X(publishedOutsideDomain) X(downloadUri) X(exportLinks) \
+    X(lastModifyingUserName) X(lastModifyingUser) X(originalFilename) X(md5Checksum) X(fileSize)
+
 class GRevision {
 public:
+    MODIFIED_FIELDS(GREVISION_FIELDS)
     GRevision();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
 
     READONLY(std::string, etag)
     WRITABLE(std::string, id)
@@ -422,15 +590,13 @@ public:
     READONLY(std::string, originalFilename)
     READONLY(std::string, md5Checksum)
     READONLY(long, fileSize)
-
-private:
-    std::set<std::string> _fields;
 };
 
 class GRevisionList {
 public:
     GRevisionList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -442,6 +608,7 @@ class GAppIcon {
 public:
     GAppIcon();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     READONLY(std::string, category)
     READONLY(int, size)
     READONLY(std::string, iconUrl)
@@ -451,6 +618,7 @@ class GApp {
 public:
     GApp();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     READONLY(std::string, id)
     READONLY(std::string, name)
     READONLY(std::string, objectType)
@@ -480,6 +648,7 @@ class GAppList {
 public:
     GAppList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, etag)
     READONLY(std::string, selfLink)
@@ -487,11 +656,18 @@ public:
     READONLY(std::vector<std::string>, defaultAppIds)
 };
 
+#define GREPLY_FIELDS(X) \
+    X(replyId) X(createDate) X(modifiedDate) X(author) X(htmlContent) X(content) X(deleted) \
+    X(verb)
+
 class GReply {
 public:
+    MODIFIED_FIELDS(GREPLY_FIELDS)
     GReply();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 
     READONLY(std::string, replyId)
     READONLY(struct tm, createDate)
@@ -501,17 +677,13 @@ public:
     WRITABLE(std::string, content)
     READONLY(bool, deleted)
     WRITABLE(std::string, verb);
-
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
-private:
-    std::set<std::string> _fields;
 };
 
 class GReplyList {
 public:
     GReplyList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, selfLink)
     READONLY(std::string, nextPageToken)
@@ -520,21 +692,34 @@ public:
 };
 
 
+#define GCOMMENTCONTEXT_FIELDS(X) \
+    X(type) X(value)
+
 class GCommentContext {
 public:
+    FIELD_ENUMERATION(GCOMMENTCONTEXT_FIELDS)
     GCommentContext();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 
     READONLY(std::string, type)
     READONLY(std::string, value)
 };
 
+#define GCOMMENT_FIELDS(X) \
+    X(selfLink) X(commentId) X(createdDate) X(modifiedDate) X(author) X(htmlContent) X(content) \
+    X(deleted) X(status) X(context) X(anchor) X(fileId) X(fileTitle) X(replies)
+
 class GComment {
 public:
+    MODIFIED_FIELDS(GCOMMENT_FIELDS)
     GComment();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
     JObject* to_json();
+    void to_json(JsonWriter& writer, FieldMask fields = ALL_FIELDS) const;
 
     READONLY(std::string, selfLink)
     READONLY(std::string, commentId)
@@ -550,17 +735,13 @@ public:
     READONLY(std::string, fileId)
     READONLY(std::string, fileTitle)
     READONLY(std::vector<GReply>, replies)
-
-    std::set<std::string> get_modified_fields() { return _fields;}
-    void clear() { _fields.clear();}
-private:
-    std::set<std::string> _fields;
 };
 
 class GCommentList  {
 public:
     GCommentList();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(std::string, selfLink)
     READONLY(std::string, nextPageToken)
@@ -569,10 +750,25 @@ public:
 };
 
 
+// Decode a resource, honouring a GFile projection where the type has one
+template<class T>
+inline void decode_resource(T& res, JsonReader& reader, FieldMask projection) {
+    res.from_json(reader);
+}
+
+inline void decode_resource(GFile& res, JsonReader& reader, FieldMask projection) {
+    res.from_json(reader, projection);
+}
+
+inline void decode_resource(GFileList& res, JsonReader& reader, FieldMask projection) {
+    res.from_json(reader, projection);
+}
+
 class GError {
 public:
     GError();
     void from_json(JObject* obj);
+    void from_json(JsonReader& reader);
 
     READONLY(int, code)
     READONLY(std::string, message)
@@ -0,0 +1,212 @@
+#ifndef __GDRIVE_ITEMSTREAM_HPP__
+#define __GDRIVE_ITEMSTREAM_HPP__
+
+#include "gdrive/request.hpp"
+#include "gdrive/gitem.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/decodepool.hpp"
+#include "gdrive/error.hpp"
+#include "common/all.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace GDRIVE {
+
+typedef std::pair<size_t, size_t> ItemRange;
+
+/*
+ * Finds the elements of the top-level "items" array of a list response
+ * without decoding anything. The splitter is resumable: feed() scans only
+ * the bytes appended since the previous call and reports the (offset,
+ * length) of every item whose closing brace has arrived.
+ */
+class ItemSplitter {
+    public:
+        ItemSplitter();
+
+        void feed(const std::string& content, std::vector<ItemRange>& ranges);
+        void reset();
+
+        inline bool has_items() const { return _items_begin != std::string::npos; }
+        inline bool complete() const { return _items_end != std::string::npos; }
+
+        // content with the items array replaced by [], for decoding the
+        // page envelope once the items have been taken care of
+        std::string envelope(const std::string& content) const;
+    private:
+        size_t _scan;
+        int _depth;
+        bool _in_string;
+        bool _escape;
+        size_t _key_begin;
+        size_t _key_end;
+        size_t _items_begin;
+        size_t _items_end;
+        size_t _item_begin;
+};
+
+#define ITEM_DECODE_GRAIN 16
+
+// One page worth of item ranges decoded in place by DecodePool workers
+template<class ItemType>
+struct ItemDecodeJob {
+    ItemDecodeJob(const std::string& c, const std::vector<ItemRange>& r,
+            std::vector<ItemType>& i, FieldMask p)
+        :content(c), ranges(r), items(i), projection(p), failed(0) {}
+
+    static void run(void* context, size_t begin, size_t end) {
+        ItemDecodeJob* self = (ItemDecodeJob*)context;
+        JsonReader reader;
+        for (size_t i = begin; i < end; i ++) {
+            reader.reset(self->content.data() + self->ranges[i].first, self->ranges[i].second);
+            try {
+                decode_resource(self->items[i], reader, self->projection);
+            } catch (JsonParseException& e) {
+                __sync_fetch_and_or(&self->failed, 1);
+                return;
+            }
+        }
+    }
+
+    const std::string& content;
+    const std::vector<ItemRange>& ranges;
+    std::vector<ItemType>& items;
+    FieldMask projection;
+    int failed;
+};
+
+/*
+ * ResponseSink that decodes list items while the page is still downloading.
+ * Every complete item is appended to items() and handed to the optional
+ * callback; the reference passed to the callback is only valid during the
+ * call.
+ *
+ * With a DecodePool, feed() only records item boundaries and finish()
+ * decodes the whole page across the pool, keeping the item order; the
+ * callback then runs on the calling thread once the page is decoded.
+ *
+ * A malformed item marks the stream failed instead of throwing, so the
+ * caller can fall back to decoding the whole body.
+ */
+template<class ItemType>
+class ItemStream : public ResponseSink {
+    public:
+        typedef void (*ItemCallback)(ItemType& item, void* context);
+
+        ItemStream(ItemCallback callback = NULL, void* context = NULL)
+            :_callback(callback), _context(context), _projection(GFILE_ALL_FIELDS),
+            _pool(NULL), _failed(false) {}
+
+        inline void set_projection(FieldMask projection) { _projection = projection; }
+        inline void set_pool(DecodePool* pool) { _pool = pool; }
+
+        void feed(const std::string& content) {
+            if (_failed) return;
+            if (_pool != NULL) {
+                _splitter.feed(content, _ranges);
+                return;
+            }
+            _ranges.clear();
+            _splitter.feed(content, _ranges);
+            for (int i = 0; i < _ranges.size(); i ++) {
+                _reader.reset(content.data() + _ranges[i].first, _ranges[i].second);
+                _items.push_back(ItemType());
+                try {
+                    decode_resource(_items.back(), _reader, _projection);
+                } catch (JsonParseException& e) {
+                    _items.pop_back();
+                    _failed = true;
+                    return;
+                }
+                if (_callback != NULL) {
+                    _callback(_items.back(), _context);
+                }
+            }
+        }
+
+        void reset() {
+            _splitter.reset();
+            _ranges.clear();
+            _items.clear();
+            _failed = false;
+        }
+
+        /*
+         * Complete the page: decode pending items, then the envelope into
+         * list, and move the items over. Return false when the page could
+         * not be split or an item failed, leaving list untouched. A
+         * malformed envelope throws JsonParseException.
+         */
+        template<class ListType>
+        bool finish(const std::string& content, ListType& list) {
+            if (_pool != NULL && !_failed && _splitter.complete()) {
+                _decode_parallel(content);
+            }
+            if (!succeeded()) {
+                return false;
+            }
+            std::string envelope = _splitter.envelope(content);
+            JsonReader reader(envelope);
+            decode_resource(list, reader, _projection);
+            list.swap_items(_items);
+            return true;
+        }
+
+        // true when every item was decoded and the items array was closed
+        inline bool succeeded() const { return !_failed && _splitter.complete(); }
+        inline std::vector<ItemType>& items() { return _items; }
+        inline std::string envelope(const std::string& content) const { return _splitter.envelope(content); }
+    private:
+        ItemSplitter _splitter;
+        std::vector<ItemRange> _ranges;
+        std::vector<ItemType> _items;
+        JsonReader _reader;
+        ItemCallback _callback;
+        void* _context;
+        FieldMask _projection;
+        DecodePool* _pool;
+        bool _failed;
+
+        void _decode_parallel(const std::string& content) {
+            _items.clear();
+            _items.resize(_ranges.size());
+            ItemDecodeJob<ItemType> job(content, _ranges, _items, _projection);
+            _pool->run(ItemDecodeJob<ItemType>::run, (void*)&job, _ranges.size(), ITEM_DECODE_GRAIN);
+            if (job.failed) {
+                _items.clear();
+                _failed = true;
+                return;
+            }
+            if (_callback != NULL) {
+                for (int i = 0; i < _items.size(); i ++) {
+                    _callback(_items[i], _context);
+                }
+            }
+        }
+};
+
+/*
+ * Decode a list page that is already in memory, spreading the items over
+ * pool when one is given. Throw JsonParseException on malformed input.
+ *
+ *   GFileList page;
+ *   decode_list<GFileList, GFile>(content, page, &pool);
+ */
+template<class ListType, class ItemType>
+void decode_list(const std::string& content, ListType& list, DecodePool* pool,
+        FieldMask projection = GFILE_ALL_FIELDS) {
+    ItemStream<ItemType> stream;
+    stream.set_projection(projection);
+    stream.set_pool(pool);
+    stream.feed(content);
+    if (!stream.finish(content, list)) {
+        JsonReader reader(content);
+        decode_resource(list, reader, projection);
+    }
+}
+
+}
+
+#endif
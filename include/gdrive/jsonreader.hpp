@@ -0,0 +1,96 @@
+#ifndef __GDRIVE_JSONREADER_HPP__
+#define __GDRIVE_JSONREADER_HPP__
+
+#include "gdrive/error.hpp"
+
+#include <string>
+#include <stddef.h>
+
+namespace GDRIVE {
+
+enum JsonType {
+    JT_OBJECT,
+    JT_ARRAY,
+    JT_STRING,
+    JT_NUMBER,
+    JT_BOOL,
+    JT_NULL,
+    JT_END
+};
+
+/*
+ * Single-pass pull reader over a JSON buffer. Objects are walked with
+ * begin_object()/next_key(), arrays with begin_array()/next_item(), and the
+ * value under the cursor is decoded straight into the caller's field or
+ * skipped. No DOM is built and keys are decoded into a reused string.
+ *
+ * Readers are lenient the way the GItem types need them to be: null is
+ * accepted wherever a value is expected and leaves the target untouched,
+ * and numbers may arrive quoted, as Drive does for int64 fields.
+ * Malformed input throws JsonParseException.
+ *
+ * The reader does not copy its input; the buffer must outlive it. Keys
+ * and escaped strings read without a target land in scratch strings owned
+ * by the reader, so one reader kept for a page and reset() for each item
+ * allocates for them once instead of once per object.
+ */
+class JsonReader {
+    public:
+        JsonReader();
+        JsonReader(const char* data, size_t size);
+        JsonReader(const std::string& content);
+
+        // start over on another buffer, keeping the scratch strings
+        void reset(const char* data, size_t size);
+
+        // return false when the value is null
+        bool begin_object();
+        bool begin_array();
+
+        // return false once the closing bracket has been consumed
+        bool next_key(std::string& key);
+        // read the key into the reader, valid until the next key is read
+        bool next_key();
+        inline const std::string& key() const { return _key; }
+        bool next_item();
+
+        JsonType peek();
+        void read_string(std::string& value);
+        // point into the buffer, or the reader's scratch when the string
+        // has escapes; valid until the next read. false when null
+        bool read_string_span(const char*& data, size_t& size);
+        void read_bool(bool& value);
+        void read_number(int& value);
+        void read_number(long& value);
+        void read_number(long long& value);
+        void read_number(double& value);
+        void skip();
+
+        inline size_t position() const { return _pos - _begin; }
+        inline const char* data() const { return _begin; }
+    private:
+        const char* _begin;
+        const char* _pos;
+        const char* _end;
+        bool _first;
+        std::string _key;
+        std::string _scratch;
+
+        inline void _skip_space() {
+            while (_pos < _end && (*_pos == ' ' || *_pos == '\n' || *_pos == '\r' || *_pos == '\t')) {
+                _pos ++;
+            }
+        }
+        bool _null();
+        void _expect(char c);
+        void _literal(const char* word);
+        void _string(std::string& value);
+        void _skip_string();
+        bool _number_span(const char*& start, const char*& end);
+        long long _integer();
+        void _fail(const char* msg);
+};
+
+}
+
+#endif
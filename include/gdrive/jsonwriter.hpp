@@ -0,0 +1,51 @@
+#ifndef __GDRIVE_JSONWRITER_HPP__
+#define __GDRIVE_JSONWRITER_HPP__
+
+#include <string>
+#include <vector>
+
+namespace GDRIVE {
+
+/*
+ * Appends JSON text straight into a string buffer, the write-side
+ * counterpart of JsonReader. Commas and key separators are placed by the
+ * writer; callers only say where objects and arrays begin and end.
+ *
+ * reset() empties the buffer but keeps its capacity, so a writer kept on a
+ * request serializes every body into the same storage.
+ */
+class JsonWriter {
+    public:
+        JsonWriter();
+
+        void reset();
+
+        void begin_object();
+        void end_object();
+        void begin_array();
+        void end_array();
+        void key(const std::string& name);
+
+        void value(const std::string& value);
+        void value(const char* value);
+        void value(bool value);
+        void value(int value);
+        void value(long value);
+        void value(long long value);
+        void value(double value);
+
+        inline const std::string& str() const { return _buf; }
+        // exchange the buffer with other, both keep their capacity
+        inline void swap(std::string& other) { _buf.swap(other); }
+    private:
+        std::string _buf;
+        std::vector<bool> _first;
+        bool _after_key;
+
+        void _separate();
+        void _string(const char* data, size_t size);
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef __GDRIVE_LAZYFILE_HPP__
+#define __GDRIVE_LAZYFILE_HPP__
+
+#include "gdrive/gitem.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/servicerequest.hpp"
+#include "common/all.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define LAZY_GETTER(type, name, init) type get_##name() const { \
+    type rst = init; \
+    _decode(GF_##name, rst); \
+    return rst; \
+}
+
+namespace GDRIVE {
+
+/*
+ * Read-only view of a GFile over the raw JSON of one item. Construction
+ * copies the item bytes and records where the value of every known field
+ * starts; a getter decodes its field from there when it is called and
+ * nothing is kept, so listing jobs that touch a few fields per file never
+ * build the rest. Use to_gfile() when the whole object is needed.
+ *
+ * Getters return the same defaults as GFile for missing fields and throw
+ * JsonParseException when a value has the wrong type.
+ */
+class LazyGFile {
+public:
+    LazyGFile();
+    LazyGFile(const std::string& raw);
+    void from_json(JsonReader& reader);
+
+    inline bool has(GFileField field) const { return _offsets[field] != ABSENT; }
+    inline const std::string& raw() const { return _raw; }
+    GFile to_gfile() const;
+
+    LAZY_GETTER(std::string, id, "")
+    LAZY_GETTER(std::string, etag, "")
+    LAZY_GETTER(std::string, selfLink, "")
+    LAZY_GETTER(std::string, webContentLink, "")
+    LAZY_GETTER(std::string, alternateLink, "")
+    LAZY_GETTER(std::string, embedLink, "")
+    LAZY_GETTER(Links, openWithLinks, Links())
+    LAZY_GETTER(std::string, defaultOpenWithLink, "")
+    LAZY_GETTER(std::string, iconLink, "")
+    LAZY_GETTER(std::string, thumbnailLink, "")
+    LAZY_GETTER(std::string, title, "")
+    LAZY_GETTER(std::string, mimeType, "")
+    LAZY_GETTER(std::string, description, "")
+    LAZY_GETTER(GFileLabel, labels, GFileLabel())
+    LAZY_GETTER(struct tm, createdDate, tm())
+    LAZY_GETTER(struct tm, modifiedDate, tm())
+    LAZY_GETTER(struct tm, modifiedByMeDate, tm())
+    LAZY_GETTER(struct tm, lastViewedByMeDate, tm())
+    LAZY_GETTER(struct tm, sharedWithMeDate, tm())
+    LAZY_GETTER(std::string, version, "")
+    LAZY_GETTER(GUser, sharingUser, GUser())
+    LAZY_GETTER(std::vector<GParent>, parents, std::vector<GParent>())
+    LAZY_GETTER(std::string, downloadUrl, "")
+    LAZY_GETTER(GExportLink, exportLinks, GExportLink())
+    LAZY_GETTER(std::string, indexableText, "")
+    LAZY_GETTER(GPermission, userPermission, GPermission())
+    LAZY_GETTER(std::vector<GPermission>, permissions, std::vector<GPermission>())
+    LAZY_GETTER(std::string, originalFilename, "")
+    LAZY_GETTER(std::string, fileExtension, "")
+    LAZY_GETTER(std::string, md5Checksum, "")
+    LAZY_GETTER(long, fileSize, -1)
+    LAZY_GETTER(int, quotaBytesUsed, -1)
+    LAZY_GETTER(std::vector<std::string>, ownerNames, std::vector<std::string>())
+    LAZY_GETTER(std::vector<GUser>, owners, std::vector<GUser>())
+    LAZY_GETTER(std::string, lastModifyingUserName, "")
+    LAZY_GETTER(GUser, lastModifyingUser, GUser())
+    LAZY_GETTER(bool, editable, false)
+    LAZY_GETTER(bool, copyable, false)
+    LAZY_GETTER(bool, writersCanShare, false)
+    LAZY_GETTER(bool, shared, false)
+    LAZY_GETTER(bool, explicitlyTrashed, false)
+    LAZY_GETTER(bool, appDataContents, false)
+    LAZY_GETTER(std::string, headRevisionId, "")
+    LAZY_GETTER(std::vector<GProperty>, properties, std::vector<GProperty>())
+    LAZY_GETTER(GImageMediaMetaData, imageMediaMetadata, GImageMediaMetaData())
+private:
+    static const uint32_t ABSENT = 0xFFFFFFFF;
+
+    std::string _raw;
+    uint32_t _offsets[GF_FIELD_COUNT];
+
+    void _index();
+
+    void _decode(GFileField field, std::string& value) const;
+    void _decode(GFileField field, long& value) const;
+    void _decode(GFileField field, int& value) const;
+    void _decode(GFileField field, bool& value) const;
+    void _decode(GFileField field, struct tm& value) const;
+    void _decode(GFileField field, string_map& value) const;
+    void _decode(GFileField field, std::vector<std::string>& value) const;
+    void _decode(GFileField field, GFileLabel& value) const;
+    void _decode(GFileField field, GUser& value) const;
+    void _decode(GFileField field, GPermission& value) const;
+    void _decode(GFileField field, GImageMediaMetaData& value) const;
+    void _decode(GFileField field, std::vector<GParent>& value) const;
+    void _decode(GFileField field, std::vector<GPermission>& value) const;
+    void _decode(GFileField field, std::vector<GUser>& value) const;
+    void _decode(GFileField field, std::vector<GProperty>& value) const;
+};
+
+class LazyFileList {
+public:
+    LazyFileList();
+    void from_json(JsonReader& reader);
+    void swap_items(std::vector<LazyGFile>& other) { items.swap(other); }
+
+    READONLY(std::string, etag)
+    READONLY(std::string, selfLink)
+    READONLY(std::string, nextPageToken)
+    READONLY(std::string, nextLink)
+    READONLY(std::vector<LazyGFile>, items)
+};
+
+class LazyFileListRequest: public ListRequest<LazyFileList, LazyGFile> {
+    CLASS_MAKE_LOGGER
+    public:
+        LazyFileListRequest(Credential* cred, std::string uri)
+            :ListRequest<LazyFileList, LazyGFile>(cred, uri) {}
+        STRING_SET_ATTR(pageToken)
+        STRING_SET_ATTR(q)
+        LONG_SET_ATTR(maxResults)
+};
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef __GDRIVE_LOG_HPP__
+#define __GDRIVE_LOG_HPP__
+
+#include "common/all.hpp"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define GDRIVE_LOG_DEBUG 0
+#define GDRIVE_LOG_INFO 1
+#define GDRIVE_LOG_WARN 2
+#define GDRIVE_LOG_ERROR 3
+#define GDRIVE_LOG_OFF 4
+
+// calls below this level are compiled out, build with -DGDRIVE_LOG_LEVEL=... to change it
+#ifndef GDRIVE_LOG_LEVEL
+#ifdef GDRIVE_DEBUG
+#define GDRIVE_LOG_LEVEL GDRIVE_LOG_DEBUG
+#else
+#define GDRIVE_LOG_LEVEL GDRIVE_LOG_INFO
+#endif
+#endif
+
+#define LOG_RING_SIZE 4096
+#define LOG_ENDPOINT_SIZE 32
+#define LOG_MESSAGE_SIZE 192
+
+/*
+ * The condition is a constant, a call under GDRIVE_LOG_LEVEL is dropped
+ * by the compiler together with its arguments.
+ */
+#define GLOG_REQUEST(level, request_id, endpoint, status, ...) do { \
+    if ((level) >= GDRIVE_LOG_LEVEL) \
+        GDRIVE::AsyncLog::shared().log((level), (request_id), (endpoint), (status), __VA_ARGS__); \
+} while (0)
+#define GLOG(level, ...) GLOG_REQUEST(level, 0, NULL, 0, __VA_ARGS__)
+#define GLOG_DEBUG(...) GLOG(GDRIVE_LOG_DEBUG, __VA_ARGS__)
+#define GLOG_INFO(...) GLOG(GDRIVE_LOG_INFO, __VA_ARGS__)
+#define GLOG_WARN(...) GLOG(GDRIVE_LOG_WARN, __VA_ARGS__)
+#define GLOG_ERROR(...) GLOG(GDRIVE_LOG_ERROR, __VA_ARGS__)
+
+namespace GDRIVE {
+
+struct LogRecord {
+    int level;
+    long long time_ms;
+    // 0 and NULL when the record is not about a request
+    unsigned long request_id;
+    int status;
+    char endpoint[LOG_ENDPOINT_SIZE];
+    char message[LOG_MESSAGE_SIZE];
+};
+
+/*
+ * Log records with request fields, written out by a background thread.
+ *
+ * log() formats into a slot of a fixed ring of LOG_RING_SIZE records,
+ * claimed with a compare and swap, and returns; it never waits on the
+ * output, and takes a lock only to wake the writer when the writer has
+ * found the ring empty and gone to sleep. When the writer falls behind
+ * and the ring is full the record is dropped and counted. Records go to stderr as logfmt
+ * lines unless set_output() or set_function() says otherwise.
+ */
+class AsyncLog {
+    CLASS_MAKE_LOGGER
+    public:
+        typedef void (*LogFunction)(const LogRecord& record, void* context);
+
+        AsyncLog();
+        ~AsyncLog();
+
+        void log(int level, unsigned long request_id, const char* endpoint, int status, const char* format, ...)
+            __attribute__((format(printf, 6, 7)));
+
+        // records under level are dropped before formatting
+        inline void set_level(int level) { _level = level; }
+        void set_output(FILE* file);
+        void set_function(LogFunction function, void* context);
+        // waits until every record logged so far is written
+        void flush();
+        inline unsigned long dropped() const { return _dropped; }
+
+        static AsyncLog& shared();
+        // "ts=... level=... req=... endpoint=... status=... msg=..." without the newline
+        static void format(const LogRecord& record, char* buffer, size_t size);
+    private:
+        struct Slot {
+            volatile unsigned long sequence;
+            LogRecord record;
+        };
+
+        Slot* _slots;
+        volatile unsigned long _tail;
+        unsigned long _head;
+        volatile unsigned long _written;
+        volatile unsigned long _dropped;
+        volatile int _level;
+        volatile bool _stop;
+        FILE* _file;
+        LogFunction _function;
+        void* _context;
+        pthread_mutex_t _output_lock;
+        // _wake for the writer when records come, _drained for flush()
+        pthread_mutex_t _wake_lock;
+        pthread_cond_t _wake;
+        pthread_cond_t _drained;
+        volatile bool _sleeping;
+        pthread_t _writer;
+
+        bool _ready();
+        bool _drain();
+        static void* _write_loop(void* self);
+
+        AsyncLog(const AsyncLog& other);
+        AsyncLog& operator=(const AsyncLog& other);
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef __GDRIVE_METACACHE_HPP__
+#define __GDRIVE_METACACHE_HPP__
+
+#include "gdrive/config.hpp"
+#include "gdrive/gitem.hpp"
+#include "gdrive/error.hpp"
+#include "common/all.hpp"
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+
+namespace GDRIVE {
+
+typedef uint32_t CacheSlot;
+
+class QueryNode;
+class QueryEvaluator;
+
+/*
+ * Local copy of file metadata, fed from listings and the changes feed.
+ *
+ * Every file lives in a numbered slot. Secondary indexes on mimeType, parent,
+ * modifiedDate and the trashed label map to ordered slot sets, so LocalQuery
+ * can answer the usual dashboard queries with a few set operations instead
+ * of a files.list round trip.
+ */
+class MetadataCache {
+    CLASS_MAKE_LOGGER
+    public:
+        MetadataCache();
+
+        void put(GFile& file);
+        void put(std::vector<GFile>& files);
+        void remove(const std::string& id);
+        void apply(GChange& change);
+        void apply(std::vector<GChange>& changes);
+
+        bool get(const std::string& id, GFile& file) const;
+        inline bool contains(const std::string& id) const { return _slots.find(id) != _slots.end(); }
+        inline size_t size() const { return _slots.size(); }
+
+        // throw QueryException when q falls outside the supported grammar
+        std::vector<GFile> query(const std::string& q) const;
+        std::vector<std::string> query_ids(const std::string& q) const;
+
+        void clear();
+    private:
+        struct Entry {
+            Entry() :modified(0), live(false) {}
+            GFile file;
+            std::string title_lower;
+            time_t modified;
+            bool live;
+        };
+
+        std::vector<Entry> _entries;
+        std::vector<CacheSlot> _free;
+        std::unordered_map<std::string, CacheSlot> _slots;
+
+        std::unordered_map<std::string, std::set<CacheSlot> > _by_mimetype;
+        std::unordered_map<std::string, std::set<CacheSlot> > _by_parent;
+        std::multimap<time_t, CacheSlot> _by_modified;
+        std::set<CacheSlot> _trashed;
+
+        void _index(CacheSlot slot);
+        void _unindex(CacheSlot slot);
+
+        friend class QueryEvaluator;
+};
+
+/*
+ * A parsed files.list q expression evaluated against a MetadataCache.
+ * Supported subset:
+ *   mimeType = | != 'value'
+ *   title contains | = | != 'value'
+ *   modifiedDate < | <= | = | != | >= | > 'RFC 3339 date'
+ *   'folder id' in parents
+ *   trashed = | != true | false
+ * combined with and, or, not and parentheses.
+ *
+ * Parse once and evaluate many times when the same dashboard query repeats.
+ */
+class LocalQuery {
+    public:
+        LocalQuery(const std::string& q);
+        ~LocalQuery();
+
+        std::vector<CacheSlot> evaluate(const MetadataCache& cache) const;
+    private:
+        QueryNode* _root;
+
+        LocalQuery(const LocalQuery& other);
+        LocalQuery& operator=(const LocalQuery& other);
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef __GDRIVE_METRICS_HPP__
+#define __GDRIVE_METRICS_HPP__
+
+#include "gdrive/request.hpp"
+#include "common/all.hpp"
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#define METRICS_MAX_ENDPOINTS 64
+#define METRICS_BUCKETS 14
+
+namespace GDRIVE {
+
+/*
+ * Counters and latency histograms of the API calls made through
+ * CredentialHttpRequest, kept per endpoint ("files.get", "changes.list",
+ * "files.upload_chunk", ...) and exported in the Prometheus text format.
+ *
+ * Each thread records into its own shard with plain atomic adds, so
+ * recording takes no lock once a thread has made its first call. Export
+ * sums the shards while holding the registry lock. The shard of a thread
+ * that exits keeps its counts and is handed to the next new thread, so
+ * there are never more shards than threads alive at once. Endpoints past
+ * METRICS_MAX_ENDPOINTS are counted as "other".
+ */
+class Metrics {
+    CLASS_MAKE_LOGGER
+    public:
+        typedef void (*ExportFunction)(const std::string& text, void* context);
+
+        Metrics();
+        ~Metrics();
+
+        // id of an endpoint, registered on first use
+        int endpoint(const std::string& name);
+        /*
+         * One transfer of an endpoint. status is the HTTP status, 0 when
+         * the transfer failed; throttled transfers also add their time to
+         * the throttled total.
+         */
+        void record(int endpoint, int status, const TransferTiming& timing, bool throttled);
+        void record_refresh();
+
+        // appends the exposition text to out
+        void write_prometheus(std::string& out);
+        // writes the text next to path and renames it over path
+        bool dump(const std::string& path);
+        void export_to(ExportFunction function, void* context);
+        // bytes held by the registry and its shards
+        size_t memory_usage();
+
+        // the registry requests record into unless given another one
+        static Metrics& shared();
+        // "files.get" for a GET of SERVICE_URI/files/<id>, "other" when unknown
+        static std::string endpoint_name(RequestMethod method, const std::string& uri);
+    private:
+        struct EndpointStats {
+            // per bucket, the last one is +Inf
+            unsigned long long buckets[METRICS_BUCKETS + 1];
+            unsigned long long sum;
+            // failed transfers, then 1xx to 5xx
+            unsigned long long codes[6];
+            unsigned long long bytes_up;
+            unsigned long long bytes_down;
+            unsigned long long throttled;
+        };
+        struct Shard {
+            EndpointStats endpoints[METRICS_MAX_ENDPOINTS];
+            unsigned long long refreshes;
+            Metrics* owner;
+        };
+
+        pthread_key_t _key;
+        pthread_mutex_t _lock;
+        std::vector<Shard*> _shards;
+        // shards of exited threads, still counted by export
+        std::vector<Shard*> _free;
+        std::vector<std::string> _endpoints;
+
+        Shard* _shard();
+        static void _release_shard(void* shard);
+
+        Metrics(const Metrics& other);
+        Metrics& operator=(const Metrics& other);
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __GDRIVE_PATHINDEX_HPP__
+#define __GDRIVE_PATHINDEX_HPP__
+
+#include "gdrive/config.hpp"
+#include "gdrive/credential.hpp"
+#include "gdrive/gitem.hpp"
+#include "common/all.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace GDRIVE {
+
+/*
+ * A trie of the drive keyed by (parent id, title). Every folder id is a node
+ * and every title is an edge to the ids of the children carrying it, so a
+ * path is resolved with one map lookup per component.
+ *
+ * Drive allows several children of a folder to share a title. In that case
+ * the lexicographically smallest id wins, so repeated resolutions agree no
+ * matter in which order the listings were fed in.
+ */
+class PathIndex {
+    CLASS_MAKE_LOGGER
+    public:
+        PathIndex();
+
+        // replaces the entries of the file, a trashed file only loses them
+        void add(GFile& file);
+        void add(std::vector<GFile>& files);
+        void add_child(std::string parent_id, std::string title, std::string id);
+        void remove(std::string id);
+
+        // Changes feed invalidation
+        void apply(GChange& change);
+        void apply(std::vector<GChange>& changes);
+
+        bool lookup(std::string parent_id, std::string title, std::string& id);
+        std::vector<std::string> lookup_all(std::string parent_id, std::string title);
+        bool resolve(std::string path, std::string& id);
+
+        inline size_t size() const { return _entries.size(); }
+        void clear();
+
+        static std::vector<std::string> split_path(std::string path);
+    private:
+        typedef std::map<std::string, std::set<std::string> > TitleMap;
+        typedef std::pair<std::string, std::string> EntryKey;
+
+        std::map<std::string, TitleMap> _children;
+        std::map<std::string, std::vector<EntryKey> > _entries;
+};
+
+/*
+ * Resolves paths against the in-memory index and falls back to one
+ * ChildrenListRequest per missing component, feeding the answer back into
+ * the index so the next resolution of the same prefix stays in memory.
+ */
+class PathResolver {
+    CLASS_MAKE_LOGGER
+    public:
+        PathResolver(Credential* cred);
+
+        std::string resolve(std::string path);
+        inline void apply(GChange& change) { _index.apply(change); }
+        inline void apply(std::vector<GChange>& changes) { _index.apply(changes); }
+        inline PathIndex& index() { return _index; }
+    private:
+        bool _fetch(std::string parent_id, std::string title);
+
+        Credential* _cred;
+        PathIndex _index;
+};
+
+}
+
+#endif
@@ -2,10 +2,14 @@
 #define __GDRIVE_REQUEST_HPP__
 
 #include "gdrive/config.hpp"
+#include "gdrive/bufferpool.hpp"
 #include "common/all.hpp"
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
+#include <utility>
+#include <string.h>
 #include <curl/curl.h>
 
 namespace GDRIVE {
@@ -23,12 +27,80 @@ enum EncodeMethod {
     EM_JSON,
 };
 
-typedef std::map<std::string, std::string> RequestHeader;
-typedef std::map<std::string, std::string> RequestQuery;
+/*
+ * The few string pairs a request carries, kept in one vector in the order
+ * they were set. Lookups are a linear scan, which beats a tree at this
+ * size. clear() and erase() keep the storage of the dropped entries and
+ * hand it to the next keys set, so a request that is filled with the same
+ * headers again does not allocate.
+ */
+class FlatStringMap {
+    public:
+        typedef std::pair<std::string, std::string> value_type;
+        typedef std::vector<value_type>::iterator iterator;
+        typedef std::vector<value_type>::const_iterator const_iterator;
+
+        FlatStringMap() :_size(0) {}
+
+        std::string& operator[](const std::string& key) { return _lookup(key.data(), key.size()); }
+        std::string& operator[](const char* key) { return _lookup(key, strlen(key)); }
+        iterator find(const std::string& key) { return begin() + _index(key.data(), key.size()); }
+        const_iterator find(const std::string& key) const { return begin() + _index(key.data(), key.size()); }
+        void erase(const std::string& key);
+        void insert(const_iterator first, const_iterator last);
+
+        inline iterator begin() { return _entries.begin(); }
+        inline iterator end() { return _entries.begin() + _size; }
+        inline const_iterator begin() const { return _entries.begin(); }
+        inline const_iterator end() const { return _entries.begin() + _size; }
+        inline size_t size() const { return _size; }
+        inline void clear() { _size = 0; }
+    private:
+        std::vector<value_type> _entries;
+        // entries past _size are spare storage
+        size_t _size;
+
+        size_t _index(const char* key, size_t length) const;
+        std::string& _lookup(const char* key, size_t length);
+};
+
+typedef FlatStringMap RequestHeader;
+typedef FlatStringMap RequestQuery;
 typedef size_t (*ReadFunction) (void*, size_t, size_t, void*);
 
+// room taken for a body whose length the server did not announce
+#define RESPONSE_INITIAL_BUFFER 16384
+
 class HttpResponse;
 class HttpRequest;
+class Metrics;
+
+/*
+ * Where the time of one transfer went, as curl measured it. Times are
+ * microseconds from the start of the transfer and cumulative: connect
+ * includes namelookup, appconnect is the end of the TLS handshake,
+ * starttransfer is the first response byte. Byte counts are bodies only.
+ * retries counts the sends a call needed past the first, e.g. after a 401
+ * refreshed the token or a resumable upload was resumed.
+ */
+struct TransferTiming {
+    long long namelookup;
+    long long connect;
+    long long appconnect;
+    long long pretransfer;
+    long long starttransfer;
+    long long total;
+    long long bytes_up;
+    long long bytes_down;
+    int retries;
+
+    TransferTiming()
+        :namelookup(0), connect(0), appconnect(0), pretransfer(0), starttransfer(0),
+        total(0), bytes_up(0), bytes_down(0), retries(0) {}
+    // from the request being sent to the first byte back
+    inline long long server_time() const { return starttransfer - pretransfer; }
+    inline long long transfer_time() const { return total - starttransfer; }
+};
 
 class MemoryString {
     public:
@@ -48,24 +120,85 @@ class MemoryString {
         int _pos;
 };
 
+/*
+ * Sees the response body while the transfer is still running. feed() is
+ * called from the write callback after every network chunk with the whole
+ * body received so far, and reset() when the response is cleared for a
+ * retry. feed() must not throw; curl cannot unwind through it.
+ */
+class ResponseSink {
+    public:
+        virtual ~ResponseSink() {}
+        virtual void feed(const std::string& content) = 0;
+        virtual void reset() = 0;
+};
+
 class HttpResponse {
     CLASS_MAKE_LOGGER
     public:
-        HttpResponse() { _header_map.clear(); }
+        HttpResponse()
+            :_sink(NULL), _pool(&BufferPool::shared()), _expected_length(0),
+            _block_start(0), _header_indexed(false), _handle(NULL) {}
+        // a copy may outlive its request, so it keeps neither the curl
+        // handle nor the sink and answers get_header() from its own text
+        HttpResponse(const HttpResponse& other);
+        HttpResponse& operator=(const HttpResponse& other);
+        ~HttpResponse() { if (_pool != NULL) _pool->release(_content); }
         static size_t curl_write_callback(void* content, size_t size, size_t nmemb, void* userp);
-        inline std::string content() const { return _content; };
-        inline std::string header() const { return _header; };
-        inline void clear() { _content = ""; _header = ""; _header_map.clear(); }
+        static size_t curl_header_callback(void* content, size_t size, size_t nmemb, void* userp);
+        inline const std::string& content() const { return _content; };
+        inline const std::string& header() const { return _header; };
+        // the same bytes for parsers that take a view, valid until clear()
+        inline std::string_view content_view() const { return _content; }
+        inline std::string_view header_view() const { return _header; }
+        // keeps the storage of the body for the next transfer
+        inline void clear() {
+            _content.clear(); _header.clear(); _header_index.clear();
+            _block_start = 0; _header_indexed = false;
+            _timing = TransferTiming();
+            _expected_length = 0;
+            if (_sink != NULL) _sink->reset();
+        }
+        inline void set_sink(ResponseSink* sink) { _sink = sink; }
+        // where the body buffer comes from and goes back to, NULL for none
+        inline void set_buffer_pool(BufferPool* pool) { _pool = pool; }
         inline int status() const { return _status; }
         inline void set_status(int status) { _status = status;}
+        inline const TransferTiming& timing() const { return _timing; }
+        inline void set_retries(int retries) { _timing.retries = retries; }
 
-        std::string get_header(std::string field);
+        /*
+         * Value of a header of the final response, matched without regard
+         * to case; the blocks of redirects and 100 Continue are skipped.
+         * Empty when the header was not sent. get_header() asks curl
+         * through curl_easy_header() first when libcurl has it,
+         * find_header() reads the received header text and points into it.
+         */
+        std::string get_header(const std::string& field);
+        bool find_header(const char* field, const char*& value, size_t& length);
         void _parse_header();
     private:
         std::string _content;
         std::string _header;
         int _status;
-        std::map<std::string, std::string> _header_map;
+        // name and value of one header line, as offsets into _header
+        struct HeaderSpan {
+            size_t name;
+            size_t name_length;
+            size_t value;
+            size_t value_length;
+        };
+        std::vector<HeaderSpan> _header_index;
+        ResponseSink* _sink;
+        BufferPool* _pool;
+        // Content-Length of the current response, 0 when not sent
+        size_t _expected_length;
+        // where the last status line starts in _header
+        size_t _block_start;
+        bool _header_indexed;
+        // the handle of the request the response belongs to
+        CURL* _handle;
+        TransferTiming _timing;
 
         friend class HttpRequest;
 };
@@ -76,16 +209,30 @@ class HttpRequest {
     public:
         HttpRequest(std::string uri, RequestMethod method);
         HttpRequest(std::string uri, RequestMethod method, RequestHeader& header, std::string body);
-        void add_header(RequestHeader &header);
-        void add_header(std::string key, std::string value);
-        void add_query(RequestQuery& query);
-        void add_query(std::string key, std::string value);
+        void add_header(const RequestHeader& header);
+        void add_header(const std::string& key, const std::string& value);
+        void add_query(const RequestQuery& query);
+        void add_query(const std::string& key, const std::string& value);
         inline void clear_header() { _header.clear();}
         inline void clear_query() { _query.clear(); }
         void clear();
         void set_uri(std::string uri);
+        /*
+         * Sends the request and returns its response, cleared of whatever
+         * the previous call received. A request can be sent again; once
+         * its buffers have grown, sending it with the same headers makes
+         * no allocations of its own.
+         */
         HttpResponse& request();
         inline HttpResponse& response() { return _resp;}
+        // pool for the request body and the response body, NULL for none
+        void set_buffer_pool(BufferPool* pool);
+        // where API calls are counted, NULL for nowhere
+        void set_metrics(Metrics* metrics);
+        // the endpoint calls are counted under, named from the uri by default
+        void set_endpoint(const std::string& endpoint);
+        // tells the log records of the last request() apart, 0 before the first
+        inline unsigned long request_id() const { return _request_id; }
         ~HttpRequest();
     protected:
         std::string _uri;
@@ -97,8 +244,33 @@ class HttpRequest {
         CURL *_handle;
         ReadFunction _read_hook;
         void* _read_context;
+        BufferPool* _pool;
+        Metrics* _metrics;
+        std::string _endpoint;
+        // id of _endpoint in _metrics, -1 until first needed
+        int _endpoint_id;
+        unsigned long _request_id;
+        // the url with the encoded query, rebuilt only when the uri or an
+        // entry of the query changed since the last request
+        std::string _url;
+        bool _url_stale;
+        // per query entry, the key and value last encoded and the
+        // "key=value" text they were encoded to
+        struct EncodedQuery {
+            std::string key;
+            std::string value;
+            std::string text;
+        };
+        std::vector<EncodedQuery> _encoded_query;
+        size_t _encoded_size;
+        // curl's copy of the headers and the "key:value\n" text it was built from
+        curl_slist* _header_list;
+        std::string _header_lines;
+        std::string _line;
         void _init_curl_handle();
-        curl_slist* _build_header();
+        void _build_header();
+        bool _build_url();
+        void _record_timing();
 };
 
 }
@@ -6,6 +6,7 @@
 #include "gdrive/util.hpp"
 #include "gdrive/gitem.hpp"
 #include "gdrive/servicerequest.hpp"
+#include "gdrive/lazyfile.hpp"
 #include "gdrive/filecontent.hpp"
 #include "common/all.hpp"
 
@@ -24,6 +25,7 @@ class FileService {
         }
         FileListRequest List();
         std::vector<GFile> Listall();
+        LazyFileListRequest ListLazy();
         FileGetRequest Get(std::string id);
         FileTrashRequest Trash(std::string id);
         FileUntrashRequest Untrash(std::string id);
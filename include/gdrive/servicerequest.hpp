@@ -7,8 +7,13 @@
 #include "gdrive/gitem.hpp"
 #include "gdrive/filecontent.hpp"
 #include "gdrive/error.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/jsonwriter.hpp"
+#include "gdrive/itemstream.hpp"
+#include "gdrive/tracer.hpp"
 #include "common/all.hpp"
 
+#include <iterator>
 #include <vector>
 #include <set>
 
@@ -46,24 +51,29 @@
 
 namespace GDRIVE {
 
-GoogleJsonResponseException make_json_exception(std::string content);
+// the error carried by a failed response, with the timing of its transfer
+GoogleJsonResponseException make_json_exception(const HttpResponse& resp);
 
 template<class ResType, RequestMethod method>
 class ResourceRequest : public CredentialHttpRequest {
     CLASS_MAKE_LOGGER
     public:
         ResourceRequest(Credential* cred, std::string uri)
-            :CredentialHttpRequest(cred, uri, method) {}
+            :CredentialHttpRequest(cred, uri, method), _projection(GFILE_ALL_FIELDS) {}
 
         ResType execute() {
             ResType _1;
+            _apply_projection();
             CredentialHttpRequest::request();
             get_resource(_1);
             return _1;
 
         }
 
+        // also drops the projection, the response is decoded in full again
         inline void clear_fields() {
+            _projection = GFILE_ALL_FIELDS;
+            _projection_fields.clear();
             if (_query.find("fields") == _query.end()) return;
             _query.erase("fields");
         }
@@ -77,17 +87,30 @@ class ResourceRequest : public CredentialHttpRequest {
         };
 
     protected:
+        FieldMask _projection;
+        // the fields parameter of the projection, sent again after clear()
+        std::string _projection_fields;
+
+        inline void _apply_projection() {
+            if (_projection_fields.size() != 0 && _query.find("fields") == _query.end()) {
+                _query["fields"] = _projection_fields;
+            }
+        }
+
         void get_resource(ResType& res) {
 
             if (_resp.status() != 200) {
-                GoogleJsonResponseException exc = make_json_exception(_resp.content());
+                GoogleJsonResponseException exc = make_json_exception(_resp);
                 throw exc;
             } else {
-                PError error;
-                JObject* obj = (JObject*)loads(_resp.content(), error);
-                if (obj != NULL) {
-                    res.from_json(obj);
-                    delete obj;
+                TraceSpan span("parse", "decode");
+                JsonReader reader(_resp.content());
+                try {
+                    decode_resource(res, reader, _projection);
+                } catch (JsonParseException& e) {
+                    // a half decoded resource is never handed back
+                    CLOG_ERROR("Malformed response at offset %d: %s\n", e.position(), e.error().c_str());
+                    throw;
                 }
             }
         }
@@ -108,9 +131,12 @@ class ResourceAttachedRequest : public ResourceRequest<ResType, method> {
         ResourceAttachedRequest(ResType* resource, Credential* cred, std::string uri)
             :ResourceRequest<ResType, method>(cred, uri), _resource(resource) {}
 
+        // the response carries the whole resource, the result is decoded
+        // from it alone instead of starting from a copy of *_resource
         ResType execute() {
             _json_encode_body();
-            ResType _1 = *_resource;
+            ResType _1;
+            this->_apply_projection();
             CredentialHttpRequest::request();
             this->get_resource(_1);
             return _1;
@@ -118,41 +144,102 @@ class ResourceAttachedRequest : public ResourceRequest<ResType, method> {
 
     protected:
         void _json_encode_body() {
-            std::set<std::string> fields = _resource->get_modified_fields();
+            FieldMask fields = _resource->get_modified_mask();
             _resource->clear();
 
-            JObject* tmp = _resource->to_json();
-            JObject* rst_obj = new JObject();
-            for(std::set<std::string>::iterator iter = fields.begin();
-                    iter != fields.end(); iter ++) {
-                std::string field = *iter;
-                if (tmp->contain(field)) {
-                    JValue* v = tmp->pop(field);
-                    rst_obj->put(field, v);
-                }
-            }
-            char* buf;
-            dumps(rst_obj, &buf);
-            delete tmp;
-            delete rst_obj;
-            this->_body = std::string(buf);
-            free(buf);
+            _writer.reset();
+            _resource->to_json(_writer, fields);
+            _writer.swap(this->_body);
 
             this->_header["Content-Type"] = "application/json";
             this->_header["Content-Length"] = VarString::itos(this->_body.size());
         }
 
+        JsonWriter _writer;
         ResType* _resource;
 };
 
-class FileListRequest: public ResourceRequest<GFileList, RM_GET> {
+/*
+ * Paged list request that decodes items as the page arrives. The body is
+ * fed to an ItemStream from the curl write callback, so items are built
+ * while the rest of the page is still on the wire, and only the page
+ * envelope is decoded after the transfer ends. With a DecodePool the items
+ * are instead decoded across its threads once the page is in.
+ */
+template<class ListType, class ItemType>
+class ListRequest : public ResourceRequest<ListType, RM_GET> {
+    CLASS_MAKE_LOGGER
+    public:
+        typedef typename ItemStream<ItemType>::ItemCallback ItemCallback;
+
+        ListRequest(Credential* cred, std::string uri)
+            :ResourceRequest<ListType, RM_GET>(cred, uri), _callback(NULL), _context(NULL), _pool(NULL) {}
+
+        // called with every item as soon as it has been decoded
+        inline void set_item_callback(ItemCallback callback, void* context = NULL) {
+            _callback = callback;
+            _context = context;
+        }
+
+        inline void set_decode_pool(DecodePool* pool) { _pool = pool; }
+
+        ListType execute() {
+            ListType _1;
+            ItemStream<ItemType> stream(_callback, _context);
+            stream.set_projection(this->_projection);
+            stream.set_pool(_pool);
+            this->_resp.set_sink(&stream);
+            this->_apply_projection();
+            try {
+                CredentialHttpRequest::request();
+            } catch (...) {
+                this->_resp.set_sink(NULL);
+                throw;
+            }
+            this->_resp.set_sink(NULL);
+
+            if (this->_resp.status() != 200) {
+                this->get_resource(_1);
+                return _1;
+            }
+            try {
+                if (!stream.finish(this->_resp.content(), _1)) {
+                    this->get_resource(_1);
+                }
+            } catch (JsonParseException& e) {
+                CLOG_ERROR("Malformed response at offset %d: %s\n", e.position(), e.error().c_str());
+                throw;
+            }
+            return _1;
+        }
+    private:
+        ItemCallback _callback;
+        void* _context;
+        DecodePool* _pool;
+};
+
+// moves the items of page to the end of out and leaves page without items
+template<class ListType, class ItemType>
+void move_items(ListType& page, std::vector<ItemType>& out) {
+    if (out.size() == 0) {
+        page.swap_items(out);
+        return;
+    }
+    std::vector<ItemType> items;
+    page.swap_items(items);
+    out.reserve(out.size() + items.size());
+    out.insert(out.end(), std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+}
+
+class FileListRequest: public ListRequest<GFileList, GFile> {
     CLASS_MAKE_LOGGER
     public:
         FileListRequest(Credential* cred, std::string uri)
-            :ResourceRequest<GFileList, RM_GET>(cred, uri) {}
+            :ListRequest<GFileList, GFile>(cred, uri) {}
         STRING_SET_ATTR(pageToken)
         STRING_SET_ATTR(q)
         void set_corpus(std::string corpus);
+        void set_projection(const GFileProjection& projection);
         void set_maxResults(int max_results);
 };
 
@@ -162,6 +249,7 @@ class FileGetRequest: public ResourceRequest<GFile, RM_GET> {
         FileGetRequest(Credential* cred, std::string uri)
             :ResourceRequest<GFile, RM_GET>(cred, uri) {}
         BOOL_SET_ATTR(updateViewedDate)
+        void set_projection(const GFileProjection& projection);
 };
 
 typedef ResourceRequest<GFile, RM_POST> FileTrashRequest;
@@ -270,11 +358,11 @@ class AboutGetRequest: public ResourceRequest<GAbout, RM_GET> {
 
 typedef ResourceRequest<GChange, RM_GET> ChangeGetRequest;
 
-class ChangeListRequest: public ResourceRequest<GChangeList, RM_GET> {
+class ChangeListRequest: public ListRequest<GChangeList, GChange> {
     CLASS_MAKE_LOGGER
     public:
         ChangeListRequest(Credential* cred, std::string uri)
-            :ResourceRequest<GChangeList, RM_GET>(cred, uri) {}
+            :ListRequest<GChangeList, GChange>(cred, uri) {}
 
         BOOL_SET_ATTR(includeDeleted)
         BOOL_SET_ATTR(includeSubscribed)
@@ -284,11 +372,11 @@ class ChangeListRequest: public ResourceRequest<GChangeList, RM_GET> {
 };
 
 
-class ChildrenListRequest: public ResourceRequest<GChildrenList, RM_GET> {
+class ChildrenListRequest: public ListRequest<GChildrenList, GChildren> {
     CLASS_MAKE_LOGGER
     public:
         ChildrenListRequest(Credential* cred, std::string uri)
-            :ResourceRequest<GChildrenList, RM_GET>(cred, uri) {}
+            :ListRequest<GChildrenList, GChildren>(cred, uri) {}
 
         LONG_SET_ATTR(maxResults)
         STRING_SET_ATTR(pageToken)
@@ -0,0 +1,117 @@
+#ifndef __GDRIVE_TRACER_HPP__
+#define __GDRIVE_TRACER_HPP__
+
+#include "gdrive/request.hpp"
+#include "common/all.hpp"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define TRACE_FLUSH_INTERVAL_MS 100
+#define TRACE_ARG_SIZE 48
+
+namespace GDRIVE {
+
+/*
+ * Writes spans of the client's work as Chrome trace events, the JSON that
+ * chrome://tracing and Perfetto open, so the overlap of concurrent
+ * requests can be seen on a timeline. Off until start() is called; while
+ * off, recording a span is one load of a flag.
+ *
+ * Every thread appends to its own buffer. A background thread takes the
+ * buffers every TRACE_FLUSH_INTERVAL_MS and writes them out, so the
+ * threads being traced never wait on the file.
+ */
+class Tracer {
+    CLASS_MAKE_LOGGER
+    public:
+        Tracer();
+        ~Tracer();
+
+        // starts writing to path, false if it cannot be opened
+        bool start(const std::string& path);
+        // writes what is buffered and closes the file
+        void stop();
+        inline bool enabled() const { return _enabled; }
+
+        /*
+         * A span of name from begin to end, microseconds on now()'s
+         * clock. name and category are kept as pointers and must be
+         * literals; arg is copied, cut to TRACE_ARG_SIZE.
+         */
+        void span(const char* name, const char* category, long long begin, long long end, const char* arg = NULL);
+        /*
+         * A transfer started at begin, as a "request" span holding one
+         * span per phase curl measured: dns, connect, tls, wait (sending
+         * the request until the first byte back) and receive.
+         */
+        void transfer(const char* endpoint, long long begin, int status, const TransferTiming& timing);
+
+        static long long now();
+        // the tracer requests report to
+        static Tracer& shared();
+    private:
+        struct Event {
+            const char* name;
+            const char* category;
+            long long begin;
+            long long duration;
+            char arg[TRACE_ARG_SIZE];
+        };
+        struct Buffer {
+            pthread_mutex_t lock;
+            std::vector<Event> events;
+        };
+
+        volatile bool _enabled;
+        bool _stop;
+        FILE* _file;
+        bool _first;
+        pthread_key_t _key;
+        pthread_mutex_t _lock;
+        pthread_cond_t _wake;
+        pthread_t _flusher;
+        std::vector<Buffer*> _buffers;
+        // taken from the buffers and being written, one per buffer in the
+        // same order, only the flusher uses it
+        std::vector<std::vector<Event> > _writing;
+
+        Buffer* _buffer();
+        void _flush();
+        static void* _flush_loop(void* self);
+
+        Tracer(const Tracer& other);
+        Tracer& operator=(const Tracer& other);
+};
+
+/*
+ * Records the time from its construction to its destruction as a span,
+ * when the shared tracer is on.
+ */
+class TraceSpan {
+    public:
+        TraceSpan(const char* name, const char* category, const char* arg = NULL)
+            :_name(name), _category(category), _arg(arg)
+        {
+            _begin = Tracer::shared().enabled() ? Tracer::now() : 0;
+        }
+        ~TraceSpan() {
+            if (_begin != 0) {
+                Tracer::shared().span(_name, _category, _begin, Tracer::now(), _arg);
+            }
+        }
+    private:
+        const char* _name;
+        const char* _category;
+        const char* _arg;
+        long long _begin;
+
+        TraceSpan(const TraceSpan& other);
+        TraceSpan& operator=(const TraceSpan& other);
+};
+
+}
+
+#endif
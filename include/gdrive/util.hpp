@@ -9,53 +9,126 @@
 #include <stdlib.h>
 #include "common/all.hpp"
 
-#define UNSAFE " $&+,/:;=@\"<>#%{}|\\^~[]`"
-
 namespace GDRIVE {
 
+/*
+ * Percent-encoding for query strings and form bodies. Which bytes are
+ * escaped is one table lookup: ASCII letters, digits and -_.!*'()? pass
+ * through, every other byte including control characters and each byte
+ * of a UTF-8 sequence becomes %XX.
+ */
 class URLHelper {
     public:
         static bool check_unsafe(char c) {
-            const char* p = UNSAFE;
-            while (*p != '\0') {
-                if (*p++ == c) return true;
-            }
-            return false;
+            return _unsafe_table()[(unsigned char)c] != 0;
         }
-        static std::string encode(std::string url) {
-            return encode(url.c_str());
+        static std::string encode(const std::string& url) {
+            std::string out;
+            encode(url.data(), url.size(), out);
+            return out;
         }
 
         static std::string encode(const char* url) {
-            COMMON::VarString vs;
-            const char* p = url;
-            while (*p != '\0') {
-                if (check_unsafe(*p)) {
-                    vs.append('%');
-                    char tmp[4] = "";
-                    sprintf(tmp, "%02X", *p);
-                    vs.append(tmp);
+            std::string out;
+            encode(url, strlen(url), out);
+            return out;
+        }
+
+        // appends the encoded form of data to out
+        static void encode(const char* data, size_t size, std::string& out) {
+            static const char HEX[] = "0123456789ABCDEF";
+            const unsigned char* table = _unsafe_table();
+            // room for the worst case, trimmed once the output is known
+            size_t start = out.size();
+            out.resize(start + size * 3);
+            char* q = &out[start];
+            for (size_t i = 0; i < size; i ++) {
+                unsigned char c = (unsigned char)data[i];
+                if (table[c]) {
+                    q[0] = '%';
+                    q[1] = HEX[c >> 4];
+                    q[2] = HEX[c & 0x0F];
+                    q += 3;
                 } else {
-                    vs.append(*p);
+                    *q++ = c;
                 }
-                p ++;
             }
-            return vs.toString();
+            out.resize(q - out.data());
         }
 
-        static std::string encode(std::map<std::string, std::string> & body) {
-            COMMON::VarString vs;
-            for(std::map<std::string, std::string>::iterator iter = body.begin(); iter != body.end(); iter ++) {
-                vs.append(iter->first).append('=').append(encode(iter->second)).append('&');
+        static std::string encode(const std::map<std::string, std::string>& body) {
+            std::string out;
+            for (std::map<std::string, std::string>::const_iterator iter = body.begin(); iter != body.end(); iter ++) {
+                if (iter != body.begin()) {
+                    out.push_back('&');
+                }
+                out.append(iter->first).push_back('=');
+                encode(iter->second.data(), iter->second.size(), out);
             }
-            if (body.size() > 0) {
-                return vs.drop().toString();
-            } else {
-                return "";
+            return out;
+        }
+
+        static std::string decode(const std::string& url) {
+            std::string out;
+            decode(url.data(), url.size(), out);
+            return out;
+        }
+
+        /*
+         * Appends the decoded form of data to out. '+' is read as a space,
+         * as in form bodies. A '%' not followed by two hex digits is kept
+         * as it is.
+         */
+        static void decode(const char* data, size_t size, std::string& out) {
+            size_t start = out.size();
+            out.resize(start + size);
+            char* q = &out[start];
+            for (size_t i = 0; i < size; i ++) {
+                char c = data[i];
+                int high, low;
+                if (c == '%' && i + 2 < size && (high = _hex_value(data[i + 1])) >= 0
+                        && (low = _hex_value(data[i + 2])) >= 0) {
+                    *q++ = (char)((high << 4) | low);
+                    i += 2;
+                } else if (c == '+') {
+                    *q++ = ' ';
+                } else {
+                    *q++ = c;
+                }
             }
+            out.resize(q - out.data());
+        }
+    private:
+        static int _hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
         }
-};
 
+        // 1 for the bytes encode() escapes
+        static const unsigned char* _unsafe_table() {
+            static const unsigned char TABLE[256] = {
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x00 control
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x10 control
+                1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, // 0x20  !"#$%&'()*+,-./
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, // 0x30 0-9 :;<=>?
+                1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x40 @A-O
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, // 0x50 P-Z [\]^_
+                1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x60 `a-o
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, // 0x70 p-z {|}~ DEL
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x80 and up, UTF-8
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+            };
+            return TABLE;
+        }
+};
 
 }
 
@@ -20,7 +20,10 @@ GFile get_file(Drive& service, std::string file_id) {
 void download_file(GFile& file, Credential* cred) {
     std::string url = file.get_downloadUrl();
     if (url == "") {
-        url = file.get_exportLinks()["application/pdf"];
+        GExportLink::const_iterator link = file.get_exportLinks().find("application/pdf");
+        if (link != file.get_exportLinks().end()) {
+            url = link->second;
+        }
     }
     CredentialHttpRequest request(cred, url, RM_GET);
     HttpResponse resp = request.request();
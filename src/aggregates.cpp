@@ -0,0 +1,134 @@
+#include "gdrive/aggregates.hpp"
+
+namespace GDRIVE {
+
+FolderTotals::FolderTotals() {
+    files = folders = bytes = quota_bytes = 0;
+}
+
+FolderTotals& FolderTotals::operator+=(const FolderTotals& other) {
+    files += other.files;
+    folders += other.folders;
+    bytes += other.bytes;
+    quota_bytes += other.quota_bytes;
+    return *this;
+}
+
+FolderTotals& FolderTotals::operator-=(const FolderTotals& other) {
+    files -= other.files;
+    folders -= other.folders;
+    bytes -= other.bytes;
+    quota_bytes -= other.quota_bytes;
+    return *this;
+}
+
+FolderAggregates::FolderAggregates() {
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("FolderAggregates", L_DEBUG)
+#endif
+}
+
+void FolderAggregates::_ensure(size_t size) {
+    if (_own.size() < size) {
+        _own.resize(size);
+        _totals.resize(size);
+    }
+}
+
+FolderTotals FolderAggregates::_contribution(NodeIndex node) const {
+    FolderTotals rst = _own[node];
+    rst += _totals[node];
+    return rst;
+}
+
+void FolderAggregates::_propagate(NodeIndex node, const FolderTotals& delta, bool add) {
+    std::vector<NodeIndex> ancestors = _graph.ancestors(node);
+    for (int i = 0; i < ancestors.size(); i ++) {
+        if (add) {
+            _totals[ancestors[i]] += delta;
+        } else {
+            _totals[ancestors[i]] -= delta;
+        }
+    }
+}
+
+void FolderAggregates::add(GFile& file) {
+    _ensure(_graph.size());
+    NodeIndex node = _graph.find(file.get_id());
+    if (node != INVALID_NODE) {
+        _propagate(node, _contribution(node), false);
+        _own[node] = FolderTotals();
+    }
+
+    node = _graph.add(file);
+    _ensure(_graph.size());
+    if (node == INVALID_NODE) {
+        // trashed, the old contribution is already gone
+        return;
+    }
+
+    FolderTotals own;
+    if (_graph.is_folder(node)) {
+        own.folders = 1;
+    } else {
+        own.files = 1;
+    }
+    if (file.get_fileSize() > 0) {
+        own.bytes = file.get_fileSize();
+    }
+    if (file.get_quotaBytesUsed() > 0) {
+        own.quota_bytes = file.get_quotaBytesUsed();
+    }
+    _own[node] = own;
+    _propagate(node, _contribution(node), true);
+}
+
+void FolderAggregates::add(std::vector<GFile>& files) {
+    for (int i = 0; i < files.size(); i ++) {
+        add(files[i]);
+    }
+}
+
+void FolderAggregates::remove(const std::string& id) {
+    NodeIndex node = _graph.find(id);
+    if (node == INVALID_NODE || _graph.is_removed(node)) {
+        return;
+    }
+    _propagate(node, _contribution(node), false);
+    _own[node] = FolderTotals();
+    _graph.remove(id);
+}
+
+void FolderAggregates::apply(GChange& change) {
+    if (change.get_deleted()) {
+        remove(change.get_fileId());
+        return;
+    }
+    GFile file = change.get_file();
+    add(file);
+}
+
+void FolderAggregates::apply(std::vector<GChange>& changes) {
+    for (int i = 0; i < changes.size(); i ++) {
+        apply(changes[i]);
+    }
+}
+
+FolderTotals FolderAggregates::totals(const std::string& id) const {
+    return totals(_graph.find(id));
+}
+
+FolderTotals FolderAggregates::totals(NodeIndex node) const {
+    if (node == INVALID_NODE || node >= _totals.size()) {
+        return FolderTotals();
+    }
+    return _totals[node];
+}
+
+void FolderAggregates::clear() {
+    _graph.clear();
+    _own.clear();
+    _totals.clear();
+}
+
+}
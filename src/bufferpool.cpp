@@ -0,0 +1,86 @@
+#include "gdrive/bufferpool.hpp"
+
+namespace GDRIVE {
+
+BufferPool::BufferPool(size_t max_retained)
+    :_retained(0), _max_retained(max_retained)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("BufferPool", L_DEBUG)
+#endif
+    pthread_mutex_init(&_lock, NULL);
+}
+
+BufferPool::~BufferPool() {
+    pthread_mutex_destroy(&_lock);
+}
+
+BufferPool& BufferPool::shared() {
+    // never destroyed, requests living in other statics may still release into it
+    static BufferPool* pool = new BufferPool();
+    return *pool;
+}
+
+void BufferPool::acquire(std::string& buffer, size_t size) {
+    buffer.clear();
+    if (buffer.capacity() >= size) {
+        return;
+    }
+    std::string pooled;
+    pthread_mutex_lock(&_lock);
+    int best = -1;
+    for (int i = 0; i < _free.size(); i ++) {
+        if (_free[i].capacity() >= size && (best < 0 || _free[i].capacity() < _free[best].capacity())) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        _retained -= _free[best].capacity();
+        pooled.swap(_free[best]);
+        _free[best].swap(_free.back());
+        _free.pop_back();
+    }
+    pthread_mutex_unlock(&_lock);
+
+    if (best < 0) {
+        buffer.reserve(size);
+        return;
+    }
+    release(buffer);
+    buffer.swap(pooled);
+}
+
+void BufferPool::release(std::string& buffer) {
+    buffer.clear();
+    size_t capacity = buffer.capacity();
+    if (capacity < BUFFER_POOL_MIN_BUFFER) {
+        return;
+    }
+    pthread_mutex_lock(&_lock);
+    if (_retained + capacity <= _max_retained && _free.size() < BUFFER_POOL_MAX_BUFFERS) {
+        _free.push_back(std::string());
+        _free.back().swap(buffer);
+        _retained += capacity;
+    }
+    pthread_mutex_unlock(&_lock);
+    // not kept, give the memory back
+    if (buffer.capacity() >= BUFFER_POOL_MIN_BUFFER) {
+        std::string().swap(buffer);
+    }
+}
+
+size_t BufferPool::retained() {
+    pthread_mutex_lock(&_lock);
+    size_t rst = _retained;
+    pthread_mutex_unlock(&_lock);
+    return rst;
+}
+
+size_t BufferPool::size() {
+    pthread_mutex_lock(&_lock);
+    size_t rst = _free.size();
+    pthread_mutex_unlock(&_lock);
+    return rst;
+}
+
+}
@@ -35,8 +35,7 @@ std::vector<GChange> ChangeService::Listall() {
     while(true) {
         GChangeList changelist = list.execute();
         list.clear();
-        const std::vector<GChange>& tmp = changelist.get_items();
-        changes.insert(changes.end(), tmp.begin(), tmp.end());
+        move_items(changelist, changes);
         std::string pageToken = changelist.get_nextPageToken();
         if (pageToken == "") {
             break;
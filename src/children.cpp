@@ -28,8 +28,7 @@ std::vector<GChildren> ChildrenService::Listall(std::string folder_id){
     while(true) {
         GChildrenList childrenlist = list.execute();
         list.clear();
-        const std::vector<GChildren>& tmp = childrenlist.get_items();
-        children.insert(children.end(), tmp.begin(), tmp.end());
+        move_items(childrenlist, children);
         std::string pageToken = childrenlist.get_nextPageToken();
         if (pageToken == "") {
             break;
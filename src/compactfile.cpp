@@ -0,0 +1,341 @@
+#include "gdrive/compactfile.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/jsonwriter.hpp"
+
+#include <string.h>
+
+namespace GDRIVE {
+
+// heap bytes behind a string, short strings keep their characters inside
+// the object itself (up to 15 of them in libstdc++)
+static size_t string_heap(const std::string& value) {
+    const char* data = value.data();
+    const char* object = (const char*)&value;
+    if (data >= object && data < object + sizeof(std::string)) {
+        return 0;
+    }
+    return value.capacity() + 1;
+}
+
+template<class T>
+static size_t vector_heap(const std::vector<T>& value) {
+    return value.capacity() * sizeof(T);
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool user_set(const GUser& user) {
+    return user.displayName != "" || user.permissionId != "" || user.picture_url != "";
+}
+
+static bool permission_set(const GPermission& permission) {
+    return permission.get_id() != "" || permission.get_role() != "";
+}
+
+static bool image_set(const GImageMediaMetaData& image) {
+    return image.width != -1 || image.height != -1 || image.date != "";
+}
+
+StringPool::StringPool() {
+    intern("");
+}
+
+StringPool::Id StringPool::intern(const std::string& value) {
+    std::map<std::string, Id>::iterator iter = _index.find(value);
+    if (iter != _index.end()) {
+        return iter->second;
+    }
+    Id id = _strings.size();
+    iter = _index.insert(std::make_pair(value, id)).first;
+    _strings.push_back(&iter->first);
+    return id;
+}
+
+size_t StringPool::memory_usage() const {
+    // a map node is the pair plus three links and a color word
+    size_t node = sizeof(std::pair<const std::string, Id>) + 4 * sizeof(void*);
+    size_t rst = sizeof(*this) + vector_heap(_strings) + _index.size() * node;
+    for (std::map<std::string, Id>::const_iterator iter = _index.begin(); iter != _index.end(); iter ++) {
+        rst += string_heap(iter->first);
+    }
+    return rst;
+}
+
+static const StringPool& empty_pool() {
+    static const StringPool pool;
+    return pool;
+}
+
+CompactFile::CompactFile()
+    :_fileSize(-1), _quotaBytesUsed(-1), _createdDate(0), _modifiedDate(0),
+    _modifiedByMeDate(0), _lastViewedByMeDate(0), _sharedWithMeDate(0),
+    _pool(&empty_pool()), _rare(NULL), _mimeType(0), _iconLink(0),
+    _fileExtension(0), _lastModifyingUserName(0), _root_parents(0), _flags(0)
+{
+    memset(_md5, 0, sizeof(_md5));
+}
+
+CompactFile::CompactFile(const GFile& file, StringPool& pool)
+    :_id(file.get_id()), _title(file.get_title()),
+    _fileSize(file.get_fileSize()), _quotaBytesUsed(file.get_quotaBytesUsed()),
+    _createdDate(file.get_createdDate_ms()),
+    _modifiedDate(file.get_modifiedDate_ms()),
+    _modifiedByMeDate(file.get_modifiedByMeDate_ms()),
+    _lastViewedByMeDate(file.get_lastViewedByMeDate_ms()),
+    _sharedWithMeDate(file.get_sharedWithMeDate_ms()),
+    _pool(&pool), _rare(NULL),
+    _mimeType(pool.intern(file.get_mimeType())),
+    _iconLink(pool.intern(file.get_iconLink())),
+    _fileExtension(pool.intern(file.get_fileExtension())),
+    _lastModifyingUserName(pool.intern(file.get_lastModifyingUserName())),
+    _root_parents(0), _flags(0)
+{
+    const std::vector<GParent>& parents = file.get_parents();
+    _parents.reserve(parents.size());
+    for (int i = 0; i < parents.size(); i ++) {
+        _parents.push_back(pool.intern(parents[i].get_id()));
+        // only the first 32 parents keep their isRoot bit
+        if (i < 32 && parents[i].get_isRoot()) {
+            _root_parents |= 1U << i;
+        }
+    }
+    const std::vector<std::string>& owner_names = file.get_ownerNames();
+    _ownerNames.reserve(owner_names.size());
+    for (int i = 0; i < owner_names.size(); i ++) {
+        _ownerNames.push_back(pool.intern(owner_names[i]));
+    }
+
+    const GFileLabel& labels = file.get_labels();
+    _set_flag(STARRED, labels.starred);
+    _set_flag(HIDDEN, labels.hidden);
+    _set_flag(TRASHED, labels.trashed);
+    _set_flag(RESTRICTED, labels.restricted);
+    _set_flag(VIEWED, labels.viewed);
+    _set_flag(EDITABLE, file.get_editable());
+    _set_flag(COPYABLE, file.get_copyable());
+    _set_flag(WRITERS_CAN_SHARE, file.get_writersCanShare());
+    _set_flag(SHARED, file.get_shared());
+    _set_flag(EXPLICITLY_TRASHED, file.get_explicitlyTrashed());
+    _set_flag(APP_DATA_CONTENTS, file.get_appDataContents());
+
+    FieldMask rare = 0;
+    memset(_md5, 0, sizeof(_md5));
+    const std::string& md5 = file.get_md5Checksum();
+    if (md5.size() == 32) {
+        _flags |= HAS_MD5;
+        for (int i = 0; i < 16; i ++) {
+            int high = hex_value(md5[2 * i]);
+            int low = hex_value(md5[2 * i + 1]);
+            if (high < 0 || low < 0) {
+                _flags &= ~HAS_MD5;
+                break;
+            }
+            _md5[i] = (unsigned char)(high << 4 | low);
+        }
+    }
+    if (md5 != "" && !_flag(HAS_MD5)) {
+        rare |= FIELD_BIT(GF_md5Checksum);
+    }
+
+    // the writer skips empty strings and maps on its own, sub-objects are
+    // written whole so they are only asked for when they carry something
+    rare |= ~inline_fields() & ~(FIELD_BIT(GF_sharingUser) | FIELD_BIT(GF_lastModifyingUser) |
+        FIELD_BIT(GF_userPermission) | FIELD_BIT(GF_imageMediaMetadata));
+    if (user_set(file.get_sharingUser())) rare |= FIELD_BIT(GF_sharingUser);
+    if (user_set(file.get_lastModifyingUser())) rare |= FIELD_BIT(GF_lastModifyingUser);
+    if (permission_set(file.get_userPermission())) rare |= FIELD_BIT(GF_userPermission);
+    if (image_set(file.get_imageMediaMetadata())) rare |= FIELD_BIT(GF_imageMediaMetadata);
+
+    JsonWriter writer;
+    file.to_json(writer, rare);
+    if (writer.str().size() > 2) {
+        _rare = new LazyGFile(writer.str());
+    }
+}
+
+CompactFile::CompactFile(const CompactFile& other)
+    :_id(other._id), _title(other._title), _fileSize(other._fileSize),
+    _quotaBytesUsed(other._quotaBytesUsed), _createdDate(other._createdDate),
+    _modifiedDate(other._modifiedDate), _modifiedByMeDate(other._modifiedByMeDate),
+    _lastViewedByMeDate(other._lastViewedByMeDate), _sharedWithMeDate(other._sharedWithMeDate),
+    _parents(other._parents), _ownerNames(other._ownerNames), _pool(other._pool),
+    _rare(other._rare == NULL ? NULL : new LazyGFile(*other._rare)),
+    _mimeType(other._mimeType), _iconLink(other._iconLink),
+    _fileExtension(other._fileExtension), _lastModifyingUserName(other._lastModifyingUserName),
+    _root_parents(other._root_parents), _flags(other._flags)
+{
+    memcpy(_md5, other._md5, sizeof(_md5));
+}
+
+CompactFile& CompactFile::operator=(const CompactFile& other) {
+    if (this == &other) {
+        return *this;
+    }
+    LazyGFile* rare = other._rare == NULL ? NULL : new LazyGFile(*other._rare);
+    delete _rare;
+    _rare = rare;
+    _id = other._id;
+    _title = other._title;
+    _fileSize = other._fileSize;
+    _quotaBytesUsed = other._quotaBytesUsed;
+    _createdDate = other._createdDate;
+    _modifiedDate = other._modifiedDate;
+    _modifiedByMeDate = other._modifiedByMeDate;
+    _lastViewedByMeDate = other._lastViewedByMeDate;
+    _sharedWithMeDate = other._sharedWithMeDate;
+    _parents = other._parents;
+    _ownerNames = other._ownerNames;
+    _pool = other._pool;
+    _mimeType = other._mimeType;
+    _iconLink = other._iconLink;
+    _fileExtension = other._fileExtension;
+    _lastModifyingUserName = other._lastModifyingUserName;
+    _root_parents = other._root_parents;
+    _flags = other._flags;
+    memcpy(_md5, other._md5, sizeof(_md5));
+    return *this;
+}
+
+CompactFile::~CompactFile() {
+    delete _rare;
+}
+
+FieldMask CompactFile::inline_fields() {
+    return FIELD_BIT(GF_id) | FIELD_BIT(GF_title) | FIELD_BIT(GF_mimeType) |
+        FIELD_BIT(GF_iconLink) | FIELD_BIT(GF_fileExtension) |
+        FIELD_BIT(GF_lastModifyingUserName) | FIELD_BIT(GF_md5Checksum) |
+        FIELD_BIT(GF_fileSize) | FIELD_BIT(GF_quotaBytesUsed) |
+        FIELD_BIT(GF_parents) | FIELD_BIT(GF_ownerNames) | FIELD_BIT(GF_labels) |
+        FIELD_BIT(GF_createdDate) | FIELD_BIT(GF_modifiedDate) |
+        FIELD_BIT(GF_modifiedByMeDate) | FIELD_BIT(GF_lastViewedByMeDate) |
+        FIELD_BIT(GF_sharedWithMeDate) | FIELD_BIT(GF_editable) |
+        FIELD_BIT(GF_copyable) | FIELD_BIT(GF_writersCanShare) |
+        FIELD_BIT(GF_shared) | FIELD_BIT(GF_explicitlyTrashed) |
+        FIELD_BIT(GF_appDataContents);
+}
+
+std::string CompactFile::get_md5Checksum() const {
+    static const char* HEX = "0123456789abcdef";
+    if (!_flag(HAS_MD5)) {
+        return _rare == NULL ? "" : _rare->get_md5Checksum();
+    }
+    std::string rst(32, '0');
+    for (int i = 0; i < 16; i ++) {
+        rst[2 * i] = HEX[_md5[i] >> 4];
+        rst[2 * i + 1] = HEX[_md5[i] & 0xF];
+    }
+    return rst;
+}
+
+const LazyGFile& CompactFile::rare() const {
+    static const LazyGFile empty;
+    return _rare == NULL ? empty : *_rare;
+}
+
+#define EPOCH_TO_WRITER(name) do {\
+    if (_##name != 0) {\
+        writer.key(#name); \
+        writer.value(time_to_string(time_from_epoch_ms(_##name))); \
+    }\
+    }while(0)
+
+#define POOLED_TO_WRITER(name) do {\
+    if (_##name != 0) {\
+        writer.key(#name); \
+        writer.value(_pool->get(_##name)); \
+    }\
+    }while(0)
+
+GFile CompactFile::to_gfile() const {
+    JsonWriter writer;
+    writer.begin_object();
+    writer.key("id");
+    writer.value(_id);
+    writer.key("title");
+    writer.value(_title);
+    POOLED_TO_WRITER(mimeType);
+    POOLED_TO_WRITER(iconLink);
+    POOLED_TO_WRITER(fileExtension);
+    POOLED_TO_WRITER(lastModifyingUserName);
+    if (_flag(HAS_MD5)) {
+        writer.key("md5Checksum");
+        writer.value(get_md5Checksum());
+    }
+    writer.key("fileSize");
+    writer.value(_fileSize);
+    writer.key("quotaBytesUsed");
+    writer.value(_quotaBytesUsed);
+    EPOCH_TO_WRITER(createdDate);
+    EPOCH_TO_WRITER(modifiedDate);
+    EPOCH_TO_WRITER(modifiedByMeDate);
+    EPOCH_TO_WRITER(lastViewedByMeDate);
+    EPOCH_TO_WRITER(sharedWithMeDate);
+    writer.key("parents");
+    writer.begin_array();
+    for (int i = 0; i < _parents.size(); i ++) {
+        writer.begin_object();
+        writer.key("id");
+        writer.value(_pool->get(_parents[i]));
+        writer.key("isRoot");
+        writer.value(get_parent_isRoot(i));
+        writer.end_object();
+    }
+    writer.end_array();
+    writer.key("ownerNames");
+    writer.begin_array();
+    for (int i = 0; i < _ownerNames.size(); i ++) {
+        writer.value(_pool->get(_ownerNames[i]));
+    }
+    writer.end_array();
+    writer.key("labels");
+    writer.begin_object();
+    writer.key("starred");
+    writer.value(get_starred());
+    writer.key("hidden");
+    writer.value(get_hidden());
+    writer.key("trashed");
+    writer.value(get_trashed());
+    writer.key("restricted");
+    writer.value(get_restricted());
+    writer.key("viewed");
+    writer.value(get_viewed());
+    writer.end_object();
+    writer.key("editable");
+    writer.value(get_editable());
+    writer.key("copyable");
+    writer.value(get_copyable());
+    writer.key("writersCanShare");
+    writer.value(get_writersCanShare());
+    writer.key("shared");
+    writer.value(get_shared());
+    writer.key("explicitlyTrashed");
+    writer.value(get_explicitlyTrashed());
+    writer.key("appDataContents");
+    writer.value(get_appDataContents());
+    writer.end_object();
+
+    GFile file;
+    JsonReader reader(writer.str());
+    file.from_json(reader);
+    if (_rare != NULL) {
+        JsonReader rare_reader(_rare->raw());
+        file.from_json(rare_reader);
+    }
+    return file;
+}
+
+size_t CompactFile::memory_usage() const {
+    size_t rst = sizeof(*this) + string_heap(_id) + string_heap(_title);
+    rst += vector_heap(_parents) + vector_heap(_ownerNames);
+    if (_rare != NULL) {
+        rst += sizeof(LazyGFile) + string_heap(_rare->raw());
+    }
+    return rst;
+}
+
+}
@@ -1,4 +1,8 @@
 #include "gdrive/credential.hpp"
+#include "gdrive/metrics.hpp"
+#include "gdrive/tracer.hpp"
+#include "gdrive/log.hpp"
+#include "gdrive/error.hpp"
 #include "jconer/json.hpp"
 
 using namespace JCONER;
@@ -57,8 +61,9 @@ CredentialHttpRequest::CredentialHttpRequest(Credential* cred, std::string uri,
 }
 
 void CredentialHttpRequest::_apply_header() {
-    add_header("Authorization", "Bearer " + _cred->_access_token);
-    add_header("user-agent", USER_AGENT);
+    // assigned in place so a request sent again reuses the header storage
+    _header["Authorization"].assign("Bearer ").append(_cred->_access_token);
+    _header["user-agent"] = USER_AGENT;
 }
 
 std::string CredentialHttpRequest::_generate_request_body() {
@@ -99,11 +104,15 @@ void CredentialHttpRequest::_parse_response(std::string content) {
 }
 
 void CredentialHttpRequest::_refresh() {
+    TraceSpan span("token_refresh", "auth");
     RequestHeader header = _generate_request_header(); 
     std::string body = _generate_request_body(); 
     
     HttpRequest request(TOKEN_URL, RM_POST, header, body);
-    HttpResponse resp = request.request();
+    HttpResponse& resp = request.request();
+    if (_metrics != NULL) {
+        _metrics->record_refresh();
+    }
 
     if (resp.status() == 200) {
         _parse_response(resp.content());
@@ -112,7 +121,26 @@ void CredentialHttpRequest::_refresh() {
     }
 }
 
-HttpResponse CredentialHttpRequest::request() {
+void CredentialHttpRequest::_record_transfer(long long begin, int status, const TransferTiming& timing) {
+    if (_endpoint.empty()) {
+        _endpoint = Metrics::endpoint_name(_method, _uri);
+    }
+    if (begin != 0) {
+        Tracer::shared().transfer(_endpoint.c_str(), begin, status, timing);
+    }
+    if (_metrics == NULL) {
+        return;
+    }
+    if (_endpoint_id < 0) {
+        _endpoint_id = _metrics->endpoint(_endpoint);
+    }
+    // 403 rateLimitExceeded and userRateLimitExceeded are throttling too
+    bool throttled = status == 429
+        || (status == 403 && _resp.content().find("ateLimitExceeded") != std::string::npos);
+    _metrics->record(_endpoint_id, status, timing, throttled);
+}
+
+HttpResponse& CredentialHttpRequest::request() {
     if (_cred->_invalid == true) {
         CLOG_FATAL("Credential is invalid\n");
     }
@@ -121,15 +149,26 @@ HttpResponse CredentialHttpRequest::request() {
         _refresh();
     }
 
-    _apply_header();
-    HttpRequest::request();
-
-    if (_resp.status() == 401) {
-        CLOG_INFO("Need to refresh\n");
+    for (int attempt = 0; attempt < 2; attempt ++) {
+        _apply_header();
+        long long begin = Tracer::shared().enabled() ? Tracer::now() : 0;
+        try {
+            HttpRequest::request();
+        } catch (CurlException& e) {
+            _record_transfer(begin, 0, e.timing());
+            GLOG_REQUEST(GDRIVE_LOG_WARN, _request_id, _endpoint.c_str(), 0, "curl error %d: %s\n", e.code(), e.error().c_str());
+            throw;
+        }
+        _record_transfer(begin, _resp.status(), _resp.timing());
+        _resp.set_retries(attempt);
+        GLOG_REQUEST(GDRIVE_LOG_DEBUG, _request_id, _endpoint.c_str(), _resp.status(),
+                     "%lld us, %lld bytes received\n", _resp.timing().total, _resp.timing().bytes_down);
+        if (_resp.status() != 401 || attempt == 1) {
+            break;
+        }
+        GLOG_REQUEST(GDRIVE_LOG_INFO, _request_id, _endpoint.c_str(), 401, "Need to refresh\n");
         _resp.clear();
         _refresh();
-        _apply_header();
-        HttpRequest::request();
     }
     return _resp;
 }
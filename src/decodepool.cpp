@@ -0,0 +1,115 @@
+#include "gdrive/decodepool.hpp"
+
+#include <unistd.h>
+
+namespace GDRIVE {
+
+DecodePool::DecodePool(int workers)
+    :_task(NULL), _context(NULL), _count(0), _grain(1), _next(0),
+    _active(0), _generation(0), _stop(false)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("DecodePool", L_DEBUG)
+#endif
+    if (workers <= 0) {
+        workers = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    }
+    pthread_mutex_init(&_run_lock, NULL);
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_wake, NULL);
+    pthread_cond_init(&_done, NULL);
+    for (int i = 0; i < workers; i ++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, DecodePool::_worker, (void*)this) != 0) {
+            CLOG_WARN("Only started %d of %d decode workers\n", i, workers);
+            break;
+        }
+        _threads.push_back(thread);
+    }
+}
+
+DecodePool::~DecodePool() {
+    pthread_mutex_lock(&_lock);
+    _stop = true;
+    pthread_cond_broadcast(&_wake);
+    pthread_mutex_unlock(&_lock);
+    for (int i = 0; i < _threads.size(); i ++) {
+        pthread_join(_threads[i], NULL);
+    }
+    pthread_cond_destroy(&_done);
+    pthread_cond_destroy(&_wake);
+    pthread_mutex_destroy(&_lock);
+    pthread_mutex_destroy(&_run_lock);
+}
+
+void DecodePool::_drain() {
+    while (true) {
+        size_t begin = __sync_fetch_and_add(&_next, _grain);
+        if (begin >= _count) {
+            break;
+        }
+        size_t end = begin + _grain < _count ? begin + _grain : _count;
+        _task(_context, begin, end);
+    }
+}
+
+void* DecodePool::_worker(void* ctx) {
+    DecodePool* self = (DecodePool*)ctx;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&self->_lock);
+    while (true) {
+        while (!self->_stop && self->_generation == seen) {
+            pthread_cond_wait(&self->_wake, &self->_lock);
+        }
+        if (self->_stop) {
+            break;
+        }
+        seen = self->_generation;
+        pthread_mutex_unlock(&self->_lock);
+
+        self->_drain();
+
+        pthread_mutex_lock(&self->_lock);
+        if (-- self->_active == 0) {
+            pthread_cond_signal(&self->_done);
+        }
+    }
+    pthread_mutex_unlock(&self->_lock);
+    return NULL;
+}
+
+void DecodePool::run(Task task, void* context, size_t count, size_t grain) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (_threads.size() == 0 || count <= grain) {
+        task(context, 0, count);
+        return;
+    }
+
+    pthread_mutex_lock(&_run_lock);
+    pthread_mutex_lock(&_lock);
+    _task = task;
+    _context = context;
+    _count = count;
+    _grain = grain;
+    _next = 0;
+    _active = _threads.size();
+    _generation ++;
+    pthread_cond_broadcast(&_wake);
+    pthread_mutex_unlock(&_lock);
+
+    _drain();
+
+    pthread_mutex_lock(&_lock);
+    while (_active > 0) {
+        pthread_cond_wait(&_done, &_lock);
+    }
+    pthread_mutex_unlock(&_lock);
+    pthread_mutex_unlock(&_run_lock);
+}
+
+}
@@ -0,0 +1,285 @@
+#include "gdrive/dirgraph.hpp"
+
+#include <algorithm>
+
+namespace GDRIVE {
+
+DirectoryGraph::DirectoryGraph()
+    :_free_edge(INVALID_EDGE)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("DirectoryGraph", L_DEBUG)
+#endif
+}
+
+NodeIndex DirectoryGraph::intern(const std::string& id) {
+    std::unordered_map<std::string, NodeIndex>::iterator iter = _index.find(id);
+    if (iter != _index.end()) {
+        return iter->second;
+    }
+    NodeIndex node = (NodeIndex)_ids.size();
+    _index[id] = node;
+    _ids.push_back(id);
+    _titles.push_back("");
+    _flags.push_back(0);
+    _first_child.push_back(INVALID_EDGE);
+    _first_parent.push_back(INVALID_EDGE);
+    return node;
+}
+
+NodeIndex DirectoryGraph::find(const std::string& id) const {
+    std::unordered_map<std::string, NodeIndex>::const_iterator iter = _index.find(id);
+    if (iter == _index.end()) {
+        return INVALID_NODE;
+    }
+    return iter->second;
+}
+
+NodeIndex DirectoryGraph::add(GFile& file) {
+    std::string id = file.get_id();
+    if (id == "") {
+        return INVALID_NODE;
+    }
+    if (file.get_labels().trashed) {
+        remove(id);
+        return INVALID_NODE;
+    }
+
+    NodeIndex node = intern(id);
+    _titles[node] = file.get_title();
+    _flags[node] = (_flags[node] & (NF_FOLDER | NF_ROOT)) | NF_KNOWN;
+    if (file.get_mimeType() == FOLDER_MIMETYPE) {
+        _flags[node] |= NF_FOLDER;
+    }
+
+    std::vector<GParent> gparents = file.get_parents();
+    std::vector<NodeIndex> parents;
+    for (int i = 0; i < gparents.size(); i ++) {
+        NodeIndex parent = intern(gparents[i].get_id());
+        _flags[parent] |= NF_FOLDER;
+        if (gparents[i].get_isRoot()) {
+            _flags[parent] |= NF_ROOT;
+        }
+        parents.push_back(parent);
+    }
+    set_parents(node, parents);
+    return node;
+}
+
+void DirectoryGraph::add(std::vector<GFile>& files) {
+    for (int i = 0; i < files.size(); i ++) {
+        add(files[i]);
+    }
+}
+
+EdgeIndex DirectoryGraph::_new_edge() {
+    if (_free_edge != INVALID_EDGE) {
+        EdgeIndex edge = _free_edge;
+        _free_edge = _edges[edge].next_child;
+        return edge;
+    }
+    _edges.push_back(Edge());
+    return (EdgeIndex)(_edges.size() - 1);
+}
+
+void DirectoryGraph::set_parents(NodeIndex node, const std::vector<NodeIndex>& parents) {
+    _unlink_parents(node);
+    // link in reverse so that the first listed parent heads the list
+    for (int i = (int)parents.size() - 1; i >= 0; i --) {
+        NodeIndex parent = parents[i];
+        EdgeIndex edge = _new_edge();
+        Edge& e = _edges[edge];
+        e.parent = parent;
+        e.child = node;
+
+        e.prev_child = INVALID_EDGE;
+        e.next_child = _first_child[parent];
+        if (e.next_child != INVALID_EDGE) {
+            _edges[e.next_child].prev_child = edge;
+        }
+        _first_child[parent] = edge;
+
+        e.prev_parent = INVALID_EDGE;
+        e.next_parent = _first_parent[node];
+        if (e.next_parent != INVALID_EDGE) {
+            _edges[e.next_parent].prev_parent = edge;
+        }
+        _first_parent[node] = edge;
+    }
+}
+
+void DirectoryGraph::_unlink(EdgeIndex edge) {
+    Edge& e = _edges[edge];
+    if (e.prev_child != INVALID_EDGE) {
+        _edges[e.prev_child].next_child = e.next_child;
+    } else {
+        _first_child[e.parent] = e.next_child;
+    }
+    if (e.next_child != INVALID_EDGE) {
+        _edges[e.next_child].prev_child = e.prev_child;
+    }
+
+    if (e.prev_parent != INVALID_EDGE) {
+        _edges[e.prev_parent].next_parent = e.next_parent;
+    } else {
+        _first_parent[e.child] = e.next_parent;
+    }
+    if (e.next_parent != INVALID_EDGE) {
+        _edges[e.next_parent].prev_parent = e.prev_parent;
+    }
+
+    e.parent = e.child = INVALID_NODE;
+    e.next_child = _free_edge;
+    _free_edge = edge;
+}
+
+void DirectoryGraph::_unlink_parents(NodeIndex node) {
+    while (_first_parent[node] != INVALID_EDGE) {
+        _unlink(_first_parent[node]);
+    }
+}
+
+void DirectoryGraph::remove(const std::string& id) {
+    NodeIndex node = find(id);
+    if (node == INVALID_NODE) {
+        return;
+    }
+    // children keep their edges, so an untrashed folder gets its subtree back
+    _unlink_parents(node);
+    _flags[node] = (_flags[node] & (NF_FOLDER | NF_ROOT)) | NF_REMOVED;
+}
+
+void DirectoryGraph::apply(GChange& change) {
+    if (change.get_deleted()) {
+        remove(change.get_fileId());
+        return;
+    }
+    GFile file = change.get_file();
+    add(file);
+}
+
+void DirectoryGraph::apply(std::vector<GChange>& changes) {
+    for (int i = 0; i < changes.size(); i ++) {
+        apply(changes[i]);
+    }
+}
+
+std::vector<NodeIndex> DirectoryGraph::parents(NodeIndex node) const {
+    std::vector<NodeIndex> rst;
+    for (EdgeIndex e = _first_parent[node]; e != INVALID_EDGE; e = _edges[e].next_parent) {
+        rst.push_back(_edges[e].parent);
+    }
+    return rst;
+}
+
+std::vector<NodeIndex> DirectoryGraph::children(NodeIndex node) const {
+    std::vector<NodeIndex> rst;
+    for (EdgeIndex e = _first_child[node]; e != INVALID_EDGE; e = _edges[e].next_child) {
+        rst.push_back(_edges[e].child);
+    }
+    return rst;
+}
+
+std::vector<NodeIndex> DirectoryGraph::ancestors(NodeIndex node) const {
+    // ancestor sets are small, a linear membership test beats hashing here
+    std::vector<NodeIndex> rst;
+    size_t head = 0;
+    NodeIndex cur = node;
+    while (true) {
+        for (EdgeIndex e = _first_parent[cur]; e != INVALID_EDGE; e = _edges[e].next_parent) {
+            NodeIndex parent = _edges[e].parent;
+            if (parent != node && std::find(rst.begin(), rst.end(), parent) == rst.end()) {
+                rst.push_back(parent);
+            }
+        }
+        if (head == rst.size()) {
+            break;
+        }
+        cur = rst[head ++];
+    }
+    return rst;
+}
+
+std::vector<NodeIndex> DirectoryGraph::subtree(NodeIndex node) const {
+    std::vector<NodeIndex> rst;
+    std::vector<bool> visited(_ids.size(), false);
+    rst.push_back(node);
+    visited[node] = true;
+    for (size_t head = 0; head < rst.size(); head ++) {
+        NodeIndex cur = rst[head];
+        for (EdgeIndex e = _first_child[cur]; e != INVALID_EDGE; e = _edges[e].next_child) {
+            NodeIndex child = _edges[e].child;
+            if (!visited[child]) {
+                visited[child] = true;
+                rst.push_back(child);
+            }
+        }
+    }
+    return rst;
+}
+
+std::string DirectoryGraph::path(NodeIndex node) const {
+    if (is_root(node)) {
+        return "/";
+    }
+    // breadth first over every parent, so a parent whose chain breaks off
+    // does not hide another that reaches a root; from[i] is the position
+    // of the node that reached[i] is a parent of
+    std::vector<NodeIndex> reached;
+    std::vector<size_t> from;
+    reached.push_back(node);
+    from.push_back(0);
+    for (size_t head = 0; head < reached.size(); head ++) {
+        for (EdgeIndex e = _first_parent[reached[head]]; e != INVALID_EDGE; e = _edges[e].next_parent) {
+            NodeIndex parent = _edges[e].parent;
+            if (is_root(parent)) {
+                std::string rst;
+                for (size_t i = head; ; i = from[i]) {
+                    rst += '/';
+                    rst += _titles[reached[i]];
+                    if (i == 0) {
+                        break;
+                    }
+                }
+                return rst;
+            }
+            if (std::find(reached.begin(), reached.end(), parent) == reached.end()) {
+                reached.push_back(parent);
+                from.push_back(head);
+            }
+        }
+    }
+    // an orphan, or every chain broken by a removed or unlisted folder
+    return "";
+}
+
+size_t DirectoryGraph::memory_usage() const {
+    size_t total = sizeof(*this);
+    total += _ids.capacity() * sizeof(std::string);
+    total += _titles.capacity() * sizeof(std::string);
+    for (size_t i = 0; i < _ids.size(); i ++) {
+        if (_ids[i].capacity() > 15) total += _ids[i].capacity() + 1;
+        if (_titles[i].capacity() > 15) total += _titles[i].capacity() + 1;
+    }
+    total += _flags.capacity() * sizeof(uint8_t);
+    total += _first_child.capacity() * sizeof(EdgeIndex);
+    total += _first_parent.capacity() * sizeof(EdgeIndex);
+    total += _edges.capacity() * sizeof(Edge);
+    // hash nodes hold a copy of the key, a value and a next pointer
+    total += _index.bucket_count() * sizeof(void*);
+    total += _index.size() * (sizeof(std::string) + sizeof(NodeIndex) + 2 * sizeof(void*));
+    return total;
+}
+
+void DirectoryGraph::clear() {
+    _index.clear();
+    _ids.clear();
+    _titles.clear();
+    _flags.clear();
+    _first_child.clear();
+    _first_parent.clear();
+    _edges.clear();
+    _free_edge = INVALID_EDGE;
+}
+
+}
@@ -0,0 +1,168 @@
+#include "gdrive/duplicates.hpp"
+#include "gdrive/drive.hpp"
+
+#include <algorithm>
+
+namespace GDRIVE {
+
+DuplicateGroup::DuplicateGroup() {
+    md5Checksum = "";
+    fileSize = -1;
+    ids.clear();
+}
+
+static bool compare_groups(const DuplicateGroup& a, const DuplicateGroup& b) {
+    if (a.reclaimable() != b.reclaimable()) {
+        return a.reclaimable() > b.reclaimable();
+    }
+    return a.md5Checksum < b.md5Checksum;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+DuplicateIndex::DuplicateIndex() {
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("DuplicateIndex", L_DEBUG)
+#endif
+}
+
+bool DuplicateIndex::_make_key(const std::string& md5, long size, Key& key) {
+    if (md5.size() != 32 || size < 0) {
+        return false;
+    }
+    key.hi = key.lo = 0;
+    for (int i = 0; i < 32; i ++) {
+        int v = hex_value(md5[i]);
+        if (v < 0) {
+            return false;
+        }
+        uint64_t& half = i < 16 ? key.hi : key.lo;
+        half = (half << 4) | (uint64_t)v;
+    }
+    key.size = size;
+    return true;
+}
+
+std::string DuplicateIndex::_md5_string(const Key& key) {
+    static const char* digits = "0123456789abcdef";
+    std::string rst(32, '0');
+    for (int i = 0; i < 16; i ++) {
+        rst[15 - i] = digits[(key.hi >> (4 * i)) & 0xF];
+        rst[31 - i] = digits[(key.lo >> (4 * i)) & 0xF];
+    }
+    return rst;
+}
+
+void DuplicateIndex::add(GFile& file) {
+    std::string id = file.get_id();
+    remove(id);
+    if (id == "" || file.get_labels().trashed) {
+        return;
+    }
+    Key key;
+    if (!_make_key(file.get_md5Checksum(), file.get_fileSize(), key)) {
+        return;
+    }
+    _groups[key].push_back(id);
+    _keys[id] = key;
+}
+
+void DuplicateIndex::add(std::vector<GFile>& files) {
+    for (int i = 0; i < files.size(); i ++) {
+        add(files[i]);
+    }
+}
+
+void DuplicateIndex::remove(const std::string& id) {
+    std::unordered_map<std::string, Key>::iterator iter = _keys.find(id);
+    if (iter == _keys.end()) {
+        return;
+    }
+    std::unordered_map<Key, std::vector<std::string>, KeyHash>::iterator group = _groups.find(iter->second);
+    if (group != _groups.end()) {
+        std::vector<std::string>& ids = group->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.size() == 0) {
+            _groups.erase(group);
+        }
+    }
+    _keys.erase(iter);
+}
+
+void DuplicateIndex::apply(GChange& change) {
+    if (change.get_deleted()) {
+        remove(change.get_fileId());
+        return;
+    }
+    GFile file = change.get_file();
+    add(file);
+}
+
+void DuplicateIndex::apply(std::vector<GChange>& changes) {
+    for (int i = 0; i < changes.size(); i ++) {
+        apply(changes[i]);
+    }
+}
+
+void DuplicateIndex::narrow(FileListRequest& list) {
+    list.clear_fields();
+    list.add_field(DUPLICATE_FIELDS);
+}
+
+void DuplicateIndex::build(Credential* cred) {
+    Drive service(cred);
+    FileListRequest list = service.files().List();
+    while (true) {
+        narrow(list);
+        list.set_maxResults(1000);
+        GFileList filelist = list.execute();
+        list.clear();
+        std::vector<GFile> items = filelist.get_items();
+        add(items);
+        std::string pageToken = filelist.get_nextPageToken();
+        if (pageToken == "") {
+            break;
+        } else {
+            list.set_pageToken(pageToken);
+        }
+    }
+}
+
+std::vector<DuplicateGroup> DuplicateIndex::groups() const {
+    std::vector<DuplicateGroup> rst;
+    for (std::unordered_map<Key, std::vector<std::string>, KeyHash>::const_iterator iter = _groups.begin();
+            iter != _groups.end(); iter ++) {
+        if (iter->second.size() < 2) {
+            continue;
+        }
+        DuplicateGroup group;
+        group.md5Checksum = _md5_string(iter->first);
+        group.fileSize = iter->first.size;
+        group.ids = iter->second;
+        std::sort(group.ids.begin(), group.ids.end());
+        rst.push_back(group);
+    }
+    std::sort(rst.begin(), rst.end(), compare_groups);
+    return rst;
+}
+
+long long DuplicateIndex::reclaimable() const {
+    long long total = 0;
+    for (std::unordered_map<Key, std::vector<std::string>, KeyHash>::const_iterator iter = _groups.begin();
+            iter != _groups.end(); iter ++) {
+        total += (long long)iter->first.size * (iter->second.size() - 1);
+    }
+    return total;
+}
+
+void DuplicateIndex::clear() {
+    _groups.clear();
+    _keys.clear();
+}
+
+}
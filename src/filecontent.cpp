@@ -1,4 +1,5 @@
 #include "gdrive/filecontent.hpp"
+#include "gdrive/log.hpp"
 
 namespace GDRIVE  {
 
@@ -33,9 +34,6 @@ std::string FileContent::get_content() {
 }
 
 size_t FileContent::read(void* ptr, size_t size, size_t nmemb, void* userp) {
-    FUNC_MAKE_LOGGER
-    FUNC_LOGGER_SET_LEVEL(COMMON::L_DEBUG);
-
     FileContent* fc = (FileContent*)userp;
 
     int remaining_length = fc->_getRemainingLength();
@@ -46,14 +44,11 @@ size_t FileContent::read(void* ptr, size_t size, size_t nmemb, void* userp) {
 
     int length = size * nmemb > remaining_length ? remaining_length : size * nmemb;
     fc->_fin.read((char*)ptr, length);
-    FLOG_DEBUG("Read %d from filecontent\n", length);
+    GLOG_DEBUG("Read %d from filecontent\n", length);
     return length;
 }
 
 size_t FileContent::resumable_read(void *ptr, size_t size, size_t nmemb, void* userp) {
-    FUNC_MAKE_LOGGER
-    FUNC_LOGGER_SET_LEVEL(COMMON::L_DEBUG);
-
     FileContent* fc = (FileContent*)userp;
 
     int remaining = fc->_resumable_length - (fc->_resumable_cur_pos - fc->_resumable_start_pos);
@@ -63,7 +58,7 @@ size_t FileContent::resumable_read(void *ptr, size_t size, size_t nmemb, void* u
 
     int length = size * nmemb > remaining ? remaining : size * nmemb;
     fc->_fin.read((char*)ptr, length);
-    FLOG_DEBUG("Read %d from filecontent\n", length);
+    GLOG_DEBUG("Read %d from filecontent\n", length);
     fc->_resumable_cur_pos += length;
     return length;
 }
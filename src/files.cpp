@@ -25,8 +25,7 @@ std::vector<GFile> FileService::Listall() {
     std::vector<GFile> files;
     while(true) {
         GFileList filelist = list.execute();
-        const std::vector<GFile>& tmp = filelist.get_items();
-        files.insert(files.end(), tmp.begin(), tmp.end());
+        move_items(filelist, files);
         list.clear();
 
         std::string pageToken = filelist.get_nextPageToken();
@@ -39,6 +38,11 @@ std::vector<GFile> FileService::Listall() {
     return files;
 }
 
+LazyFileListRequest FileService::ListLazy() {
+    LazyFileListRequest lflr(_cred, FILES_URL);
+    return lflr;
+}
+
 FileGetRequest FileService::Get(std::string id) {
     VarString vs;
     vs.append(FILES_URL).append('/').append(id);
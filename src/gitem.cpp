@@ -1,4 +1,8 @@
 #include "gdrive/gitem.hpp"
+#include "gdrive/jsonreader.hpp"
+#include "gdrive/jsonwriter.hpp"
+
+#include <string.h>
 using namespace JCONER;
 namespace GDRIVE {
 
@@ -88,6 +92,122 @@ namespace GDRIVE {
     }\
     }while(0)
 
+#define EPOCH_FROM_JSON(name) do { \
+    if (obj->contain(#name)) {\
+        name = epoch_ms_from_string(((JString*)obj->get(#name))->getValue()); \
+    }\
+    }while(0)
+
+// Streaming counterparts of the *_FROM_JSON macros. They expand inside
+// READER_BEGIN/READER_END, which walk the keys of one object; a key that
+// matches a field is decoded in place and unknown keys are skipped.
+#define READER_BEGIN \
+    if (!reader.begin_object()) return; \
+    while (reader.next_key()) { \
+        const std::string& _key = reader.key();
+
+#define READER_END \
+        reader.skip(); \
+    }
+
+// The decoding of one value, for the *_FROM_READER macros and for the
+// field switch in GFile::from_json.
+#define BOOL_READ(name) reader.read_bool(name)
+
+#define STRING_READ(name) reader.read_string(name)
+
+#define NUMBER_READ(name) reader.read_number(name)
+
+#define INSTANCE_READ(name) name.from_json(reader)
+
+#define INSTANCE_VECTOR_READ(type, name) do {\
+    if (reader.begin_array()) {\
+        while (reader.next_item()) {\
+            name.push_back(type()); \
+            name.back().from_json(reader); \
+        }\
+    }\
+    }while(0)
+
+#define STRING_MAP_READ(name) do {\
+    if (reader.begin_object()) {\
+        while (reader.next_key()) {\
+            reader.read_string(name[reader.key()]); \
+        }\
+    }\
+    }while(0)
+
+#define STRING_VECTOR_READ(name) do {\
+    if (reader.begin_array()) {\
+        while (reader.next_item()) {\
+            name.push_back(""); \
+            reader.read_string(name.back()); \
+        }\
+    }\
+    }while(0)
+
+#define STRINGMAP_VECTOR_READ(name) do {\
+    if (reader.begin_array()) {\
+        while (reader.next_item()) {\
+            name.push_back(string_map()); \
+            if (reader.begin_object()) {\
+                while (reader.next_key()) {\
+                    reader.read_string(name.back()[reader.key()]); \
+                }\
+            }\
+        }\
+    }\
+    }while(0)
+
+#define TIME_READ(name) do {\
+    const char* _1; \
+    size_t _2; \
+    if (reader.read_string_span(_1, _2)) {\
+        name = time_from_epoch_ms(epoch_ms_from_string(_1, _2)); \
+    }\
+    }while(0)
+
+#define EPOCH_READ(name) do {\
+    const char* _1; \
+    size_t _2; \
+    if (reader.read_string_span(_1, _2)) {\
+        name = epoch_ms_from_string(_1, _2); \
+    }\
+    }while(0)
+
+#define BOOL_FROM_READER(name) \
+    if (_key == #name) { BOOL_READ(name); continue; }
+
+#define STRING_FROM_READER(name) \
+    if (_key == #name) { STRING_READ(name); continue; }
+
+#define REAL_FROM_READER(name) \
+    if (_key == #name) { NUMBER_READ(name); continue; }
+
+#define INT_FROM_READER(name) \
+    if (_key == #name) { NUMBER_READ(name); continue; }
+
+#define INSTANCE_FROM_READER(name) \
+    if (_key == #name) { INSTANCE_READ(name); continue; }
+
+#define INSTANCE_VECTOR_FROM_READER(type, name) \
+    if (_key == #name) { INSTANCE_VECTOR_READ(type, name); continue; }
+
+#define STRING_MAP_FROM_READER(name) \
+    if (_key == #name) { STRING_MAP_READ(name); continue; }
+
+#define STRING_VECTOR_FROM_READER(name) \
+    if (_key == #name) { STRING_VECTOR_READ(name); continue; }
+
+#define STRINGMAP_VECTOR_FROM_READER(name) \
+    if (_key == #name) { STRINGMAP_VECTOR_READ(name); continue; }
+
+#define TIME_FROM_READER(name) \
+    if (_key == #name) { TIME_READ(name); continue; }
+
+#define EPOCH_FROM_READER(name) \
+    if (_key == #name) { EPOCH_READ(name); continue; }
+
 #define BOOL_TO_JSON(name) do {\
     if (name) obj->put(#name, new JTrue());\
     else obj->put(#name, new JFalse());\
@@ -146,21 +266,255 @@ namespace GDRIVE {
     }\
     }while(0)
 
-struct tm time_from_string(std::string time_repr ) {
+#define EPOCH_TO_JSON(name) do { \
+    if (name != 0) {\
+        obj->put(#name, epoch_ms_to_string(name)); \
+    }\
+    }while(0)
+
+// Writer counterparts of the *_TO_JSON macros with the same emptiness
+// rules. A field is written only when its bit is set in fields.
+#define WRITER_SELECTED(name) ((fields & FIELD_BIT(F_##name)) != 0)
+
+#define BOOL_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name)) {\
+        writer.key(#name); \
+        writer.value(name); \
+    }\
+    }while(0)
+
+#define STRING_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name != "") {\
+        writer.key(#name); \
+        writer.value(name); \
+    }\
+    }while(0)
+
+#define INT_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name != -1) {\
+        writer.key(#name); \
+        writer.value(name); \
+    }\
+    }while(0)
+
+#define REAL_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name != 0.0) {\
+        writer.key(#name); \
+        writer.value(name); \
+    }\
+    }while(0)
+
+#define STRING_VECTOR_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name.size() != 0) {\
+        writer.key(#name); \
+        writer.begin_array(); \
+        for (int i = 0; i < name.size(); i ++) {\
+            writer.value(name[i]); \
+        }\
+        writer.end_array(); \
+    }\
+    }while(0)
+
+#define STRING_MAP_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name.size() != 0) {\
+        writer.key(#name); \
+        writer.begin_object(); \
+        for (std::map<std::string, std::string>::const_iterator iter = name.begin(); \
+                iter != name.end(); iter ++) {\
+            writer.key(iter->first); \
+            writer.value(iter->second); \
+        }\
+        writer.end_object(); \
+    }\
+    }while(0)
+
+#define INSTANCE_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name)) {\
+        writer.key(#name); \
+        name.to_json(writer); \
+    }\
+    }while(0)
+
+#define INSTANCE_VECTOR_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name.size() != 0) {\
+        writer.key(#name); \
+        writer.begin_array(); \
+        for (int i = 0; i < name.size(); i ++) {\
+            name[i].to_json(writer); \
+        }\
+        writer.end_array(); \
+    }\
+    }while(0)
+
+#define TIME_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && (name.tm_year != 0 || name.tm_mon != 0)) {\
+        writer.key(#name); \
+        writer.value(time_to_string(name)); \
+    }\
+    }while(0)
+
+#define EPOCH_TO_WRITER(name) do {\
+    if (WRITER_SELECTED(name) && name != 0) {\
+        writer.key(#name); \
+        writer.value(epoch_ms_to_string(name)); \
+    }\
+    }while(0)
+
+// days from 1970-01-01 to the given civil date, proleptic Gregorian
+static long long days_from_civil(long long year, int month, int day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yoe = year - era * 400;
+    long long doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static int days_in_month(int year, int month) {
+    static const int DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) {
+        return 29;
+    }
+    return DAYS[month - 1];
+}
+
+// value of count decimal digits at data, -1 if any of them is not a digit
+static int read_digits(const char* data, int count) {
+    int rst = 0;
+    for (int i = 0; i < count; i ++) {
+        if (data[i] < '0' || data[i] > '9') {
+            return -1;
+        }
+        rst = rst * 10 + (data[i] - '0');
+    }
+    return rst;
+}
+
+long long epoch_ms_from_string(const char* data, size_t size) {
+    // YYYY-MM-DD alone is midnight UTC, otherwise THH:MM:SS must follow
+    // and the fraction and zone (Z, +HH:MM or -HH:MM) are optional; dates
+    // that do not exist and any other zone read as unset
+    if (size < 10 || data[4] != '-' || data[7] != '-') {
+        return 0;
+    }
+    int year = read_digits(data, 4);
+    int month = read_digits(data + 5, 2);
+    int day = read_digits(data + 8, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > days_in_month(year, month)) {
+        return 0;
+    }
+    if (size == 10) {
+        return days_from_civil(year, month, day) * 86400 * 1000;
+    }
+    if (size < 19 || data[13] != ':' || data[16] != ':') {
+        return 0;
+    }
+    if (data[10] != 'T' && data[10] != 't' && data[10] != ' ') {
+        return 0;
+    }
+    int hour = read_digits(data + 11, 2);
+    int minute = read_digits(data + 14, 2);
+    int second = read_digits(data + 17, 2);
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60) {
+        return 0;
+    }
+
+    size_t pos = 19;
+    int millis = 0;
+    if (pos < size && data[pos] == '.') {
+        pos ++;
+        int scale = 100;
+        while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+            millis += (data[pos] - '0') * scale;
+            scale /= 10;
+            pos ++;
+        }
+    }
+
+    int offset = 0;
+    if (pos < size) {
+        if (data[pos] == 'Z' || data[pos] == 'z') {
+            pos ++;
+        } else if ((data[pos] == '+' || data[pos] == '-') && pos + 6 == size && data[pos + 3] == ':') {
+            int offset_hour = read_digits(data + pos + 1, 2);
+            int offset_minute = read_digits(data + pos + 4, 2);
+            if (offset_hour < 0 || offset_hour > 23 || offset_minute < 0 || offset_minute > 59) {
+                return 0;
+            }
+            offset = offset_hour * 60 + offset_minute;
+            if (data[pos] == '-') {
+                offset = -offset;
+            }
+            pos = size;
+        }
+        if (pos != size) {
+            return 0;
+        }
+    }
+
+    long long seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return (seconds - offset * 60) * 1000 + millis;
+}
+
+long long epoch_ms_from_string(const std::string& repr) {
+    return epoch_ms_from_string(repr.data(), repr.size());
+}
+
+std::string epoch_ms_to_string(long long ms) {
+    long long seconds = ms / 1000;
+    int millis = (int)(ms % 1000);
+    if (millis < 0) {
+        millis += 1000;
+        seconds --;
+    }
+    struct tm time = time_from_epoch_ms(seconds * 1000);
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", time.tm_year + 1900, time.tm_mon + 1,
+        time.tm_mday, time.tm_hour, time.tm_min, time.tm_sec, millis);
+    return tmp;
+}
+
+struct tm time_from_string(std::string time_repr) {
+    return time_from_epoch_ms(epoch_ms_from_string(time_repr));
+}
+
+std::string time_to_string(struct tm time) {
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%04d-%02d-%02dT%02d:%02d:%02d.000Z", time.tm_year + 1900, time.tm_mon + 1,
+        time.tm_mday, time.tm_hour, time.tm_min, time.tm_sec);
+    return tmp;
+}
+
+long long time_to_epoch_ms(struct tm time) {
+    if (time.tm_year == 0 && time.tm_mon == 0 && time.tm_mday == 0) {
+        return 0;
+    }
+    long long seconds = days_from_civil(time.tm_year + 1900LL, time.tm_mon + 1, time.tm_mday) * 86400;
+    return (seconds + time.tm_hour * 3600 + time.tm_min * 60 + time.tm_sec) * 1000;
+}
+
+struct tm time_from_epoch_ms(long long ms) {
     struct tm time;
-    sscanf(time_repr.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d", &time.tm_year, &time.tm_mon, &time.tm_mday, &time.tm_hour, &time.tm_min, &time.tm_sec);
-    time.tm_year -= 1900;
-    time.tm_mon -= 1;
+    memset(&time, 0, sizeof(time));
+    if (ms == 0) {
+        return time;
+    }
+    long long seconds = ms / 1000;
+    if (ms % 1000 < 0) {
+        seconds --;
+    }
+    time_t value = (time_t)seconds;
+    gmtime_r(&value, &time);
     return time;
 }
 
-std::string time_to_string(struct tm time) {
-    char tmp[512];
-    struct tm another = time;
-    another.tm_year += 1900;
-    another.tm_mon  += 1;
-    sprintf(tmp, "%4d-%2d-%2dT%2d:%2d:%2d.000", another.tm_year, another.tm_mon, another.tm_mday, another.tm_hour,another.tm_min, another.tm_sec);
-    std::string rst(tmp);
+std::set<std::string> field_names(FieldMask mask, const char* const names[], int count) {
+    std::set<std::string> rst;
+    for (int i = 0; i < count; i ++) {
+        if (mask & FIELD_BIT(i)) {
+            rst.insert(names[i]);
+        }
+    }
     return rst;
 }
 
@@ -176,6 +530,16 @@ void GFileLabel::from_json(JObject* obj) {
     BOOL_FROM_JSON(viewed);
 }
 
+void GFileLabel::from_json(JsonReader& reader) {
+    READER_BEGIN
+    BOOL_FROM_READER(starred);
+    BOOL_FROM_READER(hidden);
+    BOOL_FROM_READER(trashed);
+    BOOL_FROM_READER(restricted);
+    BOOL_FROM_READER(viewed);
+    READER_END
+}
+
 JObject* GFileLabel::to_json() {
     JObject* obj = new JObject();
     BOOL_TO_JSON(starred);
@@ -186,6 +550,16 @@ JObject* GFileLabel::to_json() {
     return obj;
 }
 
+void GFileLabel::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    BOOL_TO_WRITER(starred);
+    BOOL_TO_WRITER(hidden);
+    BOOL_TO_WRITER(trashed);
+    BOOL_TO_WRITER(restricted);
+    BOOL_TO_WRITER(viewed);
+    writer.end_object();
+}
+
 GUser::GUser() {
     displayName = picture_url = permissionId = "";
     isAuthenticatedUser = false;
@@ -201,6 +575,23 @@ void GUser::from_json(JObject* obj) {
     }
 }
 
+void GUser::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(displayName);
+    BOOL_FROM_READER(isAuthenticatedUser);
+    STRING_FROM_READER(permissionId);
+    if (_key == "picture") {
+        if (reader.begin_object()) {
+            while (reader.next_key()) {
+                if (reader.key() == "url") reader.read_string(picture_url);
+                else reader.skip();
+            }
+        }
+        continue;
+    }
+    READER_END
+}
+
 JObject* GUser::to_json(){
     JObject* obj = new JObject();
     STRING_TO_JSON(displayName);
@@ -213,7 +604,26 @@ JObject* GUser::to_json(){
     return obj;
 }
 
+void GUser::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(displayName);
+    BOOL_TO_WRITER(isAuthenticatedUser);
+    STRING_TO_WRITER(permissionId);
+    // exception for picture url
+    if (WRITER_SELECTED(picture)) {
+        writer.key("picture");
+        writer.begin_object();
+        writer.key("url");
+        writer.value(picture_url);
+        writer.end_object();
+    }
+    writer.end_object();
+}
+
+const char* const GParent::FIELD_NAMES[] = { GPARENT_FIELDS(FIELD_NAME) };
+
 GParent::GParent() {
+    _fields = 0;
     id = selfLink = parentLink = "";
     isRoot = false;
 }
@@ -225,6 +635,15 @@ void GParent::from_json(JObject* obj) {
     BOOL_FROM_JSON(isRoot);
 }
 
+void GParent::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(parentLink);
+    BOOL_FROM_READER(isRoot);
+    READER_END
+}
+
 JObject* GParent::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(id);
@@ -234,6 +653,15 @@ JObject* GParent::to_json() {
     return obj;
 }
 
+void GParent::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(id);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(parentLink);
+    BOOL_TO_WRITER(isRoot);
+    writer.end_object();
+}
+
 GParentList::GParentList() {
     etag = selfLink = "";
     items.clear();
@@ -245,6 +673,14 @@ void GParentList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GParent, items);
 }
 
+void GParentList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    INSTANCE_VECTOR_FROM_READER(GParent, items);
+    READER_END
+}
+
 GProperty::GProperty() {
     etag = selfLink = key = visibility = value = "";
 }
@@ -257,6 +693,16 @@ void GProperty::from_json(JObject* obj) {
     STRING_FROM_JSON(value);
 }
 
+void GProperty::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(key);
+    STRING_FROM_READER(visibility);
+    STRING_FROM_READER(value);
+    READER_END
+}
+
 JObject* GProperty::to_json(){
     JObject* obj = new JObject();
     STRING_TO_JSON(etag);
@@ -267,12 +713,24 @@ JObject* GProperty::to_json(){
     return obj;
 }
 
+void GProperty::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(etag);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(key);
+    STRING_TO_WRITER(value);
+    STRING_TO_WRITER(visibility);
+    writer.end_object();
+}
+
+const char* const GPermission::FIELD_NAMES[] = { GPERMISSION_FIELDS(FIELD_NAME) };
+
 GPermission::GPermission() {
     etag = id = selfLink = name = emailAddress = domain = role = "";
     type = value = authKey = photoLink = "";
     withLink = false;
     additionalRoles.clear();
-    _fields.clear();
+    _fields = 0;
 }
 
 void GPermission::from_json(JObject* obj) {
@@ -291,6 +749,24 @@ void GPermission::from_json(JObject* obj) {
     STRING_FROM_JSON(photoLink);
 }
 
+void GPermission::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(name);
+    STRING_FROM_READER(emailAddress);
+    STRING_FROM_READER(domain);
+    STRING_FROM_READER(role);
+    STRING_VECTOR_FROM_READER(additionalRoles);
+    STRING_FROM_READER(type);
+    STRING_FROM_READER(value);
+    STRING_FROM_READER(authKey);
+    BOOL_FROM_READER(withLink);
+    STRING_FROM_READER(photoLink);
+    READER_END
+}
+
 GPermissionList::GPermissionList() {
     etag = selfLink = "";
     items.clear();
@@ -302,6 +778,14 @@ void GPermissionList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GPermission, items);
 }
 
+void GPermissionList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    INSTANCE_VECTOR_FROM_READER(GPermission, items);
+    READER_END
+}
+
 JObject* GPermission::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(etag);
@@ -320,10 +804,34 @@ JObject* GPermission::to_json() {
     return obj;
 }
 
+void GPermission::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(etag);
+    STRING_TO_WRITER(id);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(name);
+    STRING_TO_WRITER(emailAddress);
+    STRING_TO_WRITER(domain);
+    STRING_TO_WRITER(role);
+    STRING_VECTOR_TO_WRITER(additionalRoles);
+    STRING_TO_WRITER(type);
+    STRING_TO_WRITER(value);
+    STRING_TO_WRITER(authKey);
+    BOOL_TO_WRITER(withLink);
+    STRING_TO_WRITER(photoLink);
+    writer.end_object();
+}
+
 void GPermissionId::from_json(JObject* obj) {
     STRING_FROM_JSON(id);
 }
 
+void GPermissionId::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(id);
+    READER_END
+}
+
 GImageMediaMetaData::GImageMediaMetaData() {
     width = height = rotation = -1; 
     location.latitude = location.longitude = location.altitude = 0.0;
@@ -342,6 +850,14 @@ void GImageMediaMetaData::Location::from_json(JObject* obj) {
     REAL_FROM_JSON(altitude);
 }
 
+void GImageMediaMetaData::Location::from_json(JsonReader& reader) {
+    READER_BEGIN
+    REAL_FROM_READER(latitude);
+    REAL_FROM_READER(longitude);
+    REAL_FROM_READER(altitude);
+    READER_END
+}
+
 JObject* GImageMediaMetaData::Location::to_json() {
     JObject* obj = new JObject();
     REAL_TO_JSON(latitude);
@@ -350,6 +866,14 @@ JObject* GImageMediaMetaData::Location::to_json() {
     return obj;
 }
 
+void GImageMediaMetaData::Location::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    REAL_TO_WRITER(latitude);
+    REAL_TO_WRITER(longitude);
+    REAL_TO_WRITER(altitude);
+    writer.end_object();
+}
+
 void GImageMediaMetaData::from_json(JObject* obj) {
     INT_FROM_JSON(width);
     INT_FROM_JSON(height);
@@ -374,6 +898,32 @@ void GImageMediaMetaData::from_json(JObject* obj) {
     STRING_FROM_JSON(lens);
 }
 
+void GImageMediaMetaData::from_json(JsonReader& reader) {
+    READER_BEGIN
+    INT_FROM_READER(width);
+    INT_FROM_READER(height);
+    INT_FROM_READER(rotation);
+    INSTANCE_FROM_READER(location);
+    STRING_FROM_READER(date);
+    STRING_FROM_READER(cameraMaker);
+    STRING_FROM_READER(cameraModel);
+    REAL_FROM_READER(exposureTime);
+    REAL_FROM_READER(aperture);
+    BOOL_FROM_READER(flashUsed);
+    REAL_FROM_READER(focalLength);
+    INT_FROM_READER(isoSpeed);
+    STRING_FROM_READER(meteringMode);
+    STRING_FROM_READER(sensor);
+    STRING_FROM_READER(exposureMode);
+    STRING_FROM_READER(colorSpace);
+    STRING_FROM_READER(whiteBalance);
+    REAL_FROM_READER(exposureBias);
+    REAL_FROM_READER(maxApertureValue);
+    INT_FROM_READER(subjectDistance);
+    STRING_FROM_READER(lens);
+    READER_END
+}
+
 JObject* GImageMediaMetaData::to_json() {
     JObject* obj = new JObject();
     INT_TO_JSON(width);
@@ -400,7 +950,36 @@ JObject* GImageMediaMetaData::to_json() {
     return obj;
 }
 
+void GImageMediaMetaData::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    INT_TO_WRITER(width);
+    INT_TO_WRITER(height);
+    INT_TO_WRITER(rotation);
+    INSTANCE_TO_WRITER(location);
+    STRING_TO_WRITER(date);
+    STRING_TO_WRITER(cameraMaker);
+    STRING_TO_WRITER(cameraModel);
+    REAL_TO_WRITER(exposureTime);
+    REAL_TO_WRITER(aperture);
+    BOOL_TO_WRITER(flashUsed);
+    REAL_TO_WRITER(focalLength);
+    INT_TO_WRITER(isoSpeed);
+    STRING_TO_WRITER(meteringMode);
+    STRING_TO_WRITER(sensor);
+    STRING_TO_WRITER(exposureMode);
+    STRING_TO_WRITER(colorSpace);
+    STRING_TO_WRITER(whiteBalance);
+    REAL_TO_WRITER(exposureBias);
+    REAL_TO_WRITER(maxApertureValue);
+    INT_TO_WRITER(subjectDistance);
+    STRING_TO_WRITER(lens);
+    writer.end_object();
+}
+
+const char* const GFile::FIELD_NAMES[] = { GFILE_FIELDS(FIELD_NAME) };
+
 GFile::GFile() {
+    _fields = 0;
     id = etag = selfLink = webContentLink = alternateLink = embedLink = "";
     openWithLinks.clear();
     defaultOpenWithLink = iconLink = thumbnailLink = title = mimeType = description = version = downloadUrl = "";
@@ -415,6 +994,7 @@ GFile::GFile() {
     editable = copyable = writersCanShare = shared = explicitlyTrashed = appDataContents = false;
     headRevisionId = "";
     properties.clear();
+    createdDate = modifiedDate = modifiedByMeDate = lastViewedByMeDate = sharedWithMeDate = 0;
 }
 
 void GFile::from_json(JObject* obj) {
@@ -432,11 +1012,11 @@ void GFile::from_json(JObject* obj) {
     STRING_FROM_JSON(mimeType);
     STRING_FROM_JSON(description);
     INSTANCE_FROM_JSON(labels);
-    TIME_FROM_JSON(createdDate);
-    TIME_FROM_JSON(modifiedDate);
-    TIME_FROM_JSON(modifiedByMeDate);
-    TIME_FROM_JSON(lastViewedByMeDate);
-    TIME_FROM_JSON(sharedWithMeDate);
+    EPOCH_FROM_JSON(createdDate);
+    EPOCH_FROM_JSON(modifiedDate);
+    EPOCH_FROM_JSON(modifiedByMeDate);
+    EPOCH_FROM_JSON(lastViewedByMeDate);
+    EPOCH_FROM_JSON(sharedWithMeDate);
     STRING_FROM_JSON(version);
     INSTANCE_FROM_JSON(sharingUser);
     INSTANCE_VECTOR_FROM_JSON(GParent, parents);
@@ -465,6 +1045,71 @@ void GFile::from_json(JObject* obj) {
     INSTANCE_FROM_JSON(imageMediaMetadata);
 }
 
+void GFile::from_json(JsonReader& reader) {
+    from_json(reader, GFILE_ALL_FIELDS);
+}
+
+void GFile::from_json(JsonReader& reader, FieldMask projection) {
+    if (!reader.begin_object()) return;
+    while (reader.next_key()) {
+        // one lookup names the field; keys outside the projection, or not
+        // fields at all, are skipped before any decoding
+        int field = GFileProjection::field(reader.key());
+        if (field < 0 || (projection & FIELD_BIT(field)) == 0) {
+            reader.skip();
+            continue;
+        }
+        switch (field) {
+            case GF_id: STRING_READ(id); break;
+            case GF_etag: STRING_READ(etag); break;
+            case GF_selfLink: STRING_READ(selfLink); break;
+            case GF_webContentLink: STRING_READ(webContentLink); break;
+            case GF_alternateLink: STRING_READ(alternateLink); break;
+            case GF_embedLink: STRING_READ(embedLink); break;
+            case GF_defaultOpenWithLink: STRING_READ(defaultOpenWithLink); break;
+            case GF_openWithLinks: STRING_MAP_READ(openWithLinks); break;
+            case GF_iconLink: STRING_READ(iconLink); break;
+            case GF_thumbnailLink: STRING_READ(thumbnailLink); break;
+            case GF_title: STRING_READ(title); break;
+            case GF_mimeType: STRING_READ(mimeType); break;
+            case GF_description: STRING_READ(description); break;
+            case GF_labels: INSTANCE_READ(labels); break;
+            case GF_createdDate: EPOCH_READ(createdDate); break;
+            case GF_modifiedDate: EPOCH_READ(modifiedDate); break;
+            case GF_modifiedByMeDate: EPOCH_READ(modifiedByMeDate); break;
+            case GF_lastViewedByMeDate: EPOCH_READ(lastViewedByMeDate); break;
+            case GF_sharedWithMeDate: EPOCH_READ(sharedWithMeDate); break;
+            case GF_version: STRING_READ(version); break;
+            case GF_sharingUser: INSTANCE_READ(sharingUser); break;
+            case GF_parents: INSTANCE_VECTOR_READ(GParent, parents); break;
+            case GF_exportLinks: STRING_MAP_READ(exportLinks); break;
+            case GF_downloadUrl: STRING_READ(downloadUrl); break;
+            case GF_indexableText: STRING_READ(indexableText); break;
+            case GF_userPermission: INSTANCE_READ(userPermission); break;
+            case GF_permissions: INSTANCE_VECTOR_READ(GPermission, permissions); break;
+            case GF_originalFilename: STRING_READ(originalFilename); break;
+            case GF_fileExtension: STRING_READ(fileExtension); break;
+            case GF_md5Checksum: STRING_READ(md5Checksum); break;
+            case GF_fileSize: NUMBER_READ(fileSize); break;
+            case GF_quotaBytesUsed: NUMBER_READ(quotaBytesUsed); break;
+            case GF_ownerNames: STRING_VECTOR_READ(ownerNames); break;
+            case GF_owners: INSTANCE_VECTOR_READ(GUser, owners); break;
+            case GF_lastModifyingUserName: STRING_READ(lastModifyingUserName); break;
+            case GF_lastModifyingUser: INSTANCE_READ(lastModifyingUser); break;
+            case GF_editable: BOOL_READ(editable); break;
+            case GF_copyable: BOOL_READ(copyable); break;
+            case GF_writersCanShare: BOOL_READ(writersCanShare); break;
+            case GF_shared: BOOL_READ(shared); break;
+            case GF_explicitlyTrashed: BOOL_READ(explicitlyTrashed); break;
+            case GF_appDataContents: BOOL_READ(appDataContents); break;
+            case GF_headRevisionId: STRING_READ(headRevisionId); break;
+            case GF_properties: INSTANCE_VECTOR_READ(GProperty, properties); break;
+            case GF_imageMediaMetadata: INSTANCE_READ(imageMediaMetadata); break;
+            default: reader.skip(); break;
+        }
+    }
+}
+
 JObject* GFile::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(id);
@@ -481,11 +1126,11 @@ JObject* GFile::to_json() {
     STRING_TO_JSON(mimeType);
     STRING_TO_JSON(description);
     INSTANCE_TO_JSON(labels);
-    TIME_TO_JSON(createdDate);
-    TIME_TO_JSON(modifiedDate);
-    TIME_TO_JSON(modifiedByMeDate);
-    TIME_TO_JSON(lastViewedByMeDate);
-    TIME_TO_JSON(sharedWithMeDate);
+    EPOCH_TO_JSON(createdDate);
+    EPOCH_TO_JSON(modifiedDate);
+    EPOCH_TO_JSON(modifiedByMeDate);
+    EPOCH_TO_JSON(lastViewedByMeDate);
+    EPOCH_TO_JSON(sharedWithMeDate);
     STRING_TO_JSON(version);
     INSTANCE_TO_JSON(sharingUser);
     INSTANCE_VECTOR_TO_JSON(parents);
@@ -515,6 +1160,97 @@ JObject* GFile::to_json() {
     return obj;
 }
 
+void GFile::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(id);
+    STRING_TO_WRITER(etag);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(webContentLink);
+    STRING_TO_WRITER(alternateLink);
+    STRING_TO_WRITER(embedLink);
+    STRING_MAP_TO_WRITER(openWithLinks);
+    STRING_TO_WRITER(defaultOpenWithLink);
+    STRING_TO_WRITER(iconLink);
+    STRING_TO_WRITER(thumbnailLink);
+    STRING_TO_WRITER(title);
+    STRING_TO_WRITER(mimeType);
+    STRING_TO_WRITER(description);
+    INSTANCE_TO_WRITER(labels);
+    EPOCH_TO_WRITER(createdDate);
+    EPOCH_TO_WRITER(modifiedDate);
+    EPOCH_TO_WRITER(modifiedByMeDate);
+    EPOCH_TO_WRITER(lastViewedByMeDate);
+    EPOCH_TO_WRITER(sharedWithMeDate);
+    STRING_TO_WRITER(version);
+    INSTANCE_TO_WRITER(sharingUser);
+    INSTANCE_VECTOR_TO_WRITER(parents);
+    STRING_MAP_TO_WRITER(exportLinks);
+    STRING_TO_WRITER(downloadUrl);
+    STRING_TO_WRITER(indexableText);
+    INSTANCE_TO_WRITER(userPermission);
+    INSTANCE_VECTOR_TO_WRITER(permissions);
+    STRING_TO_WRITER(originalFilename);
+    STRING_TO_WRITER(fileExtension);
+    STRING_TO_WRITER(md5Checksum);
+    INT_TO_WRITER(fileSize);
+    INT_TO_WRITER(quotaBytesUsed);
+    STRING_VECTOR_TO_WRITER(ownerNames);
+    INSTANCE_VECTOR_TO_WRITER(owners);
+    STRING_TO_WRITER(lastModifyingUserName);
+    INSTANCE_TO_WRITER(lastModifyingUser);
+    BOOL_TO_WRITER(editable);
+    BOOL_TO_WRITER(copyable);
+    BOOL_TO_WRITER(writersCanShare);
+    BOOL_TO_WRITER(shared);
+    BOOL_TO_WRITER(explicitlyTrashed);
+    BOOL_TO_WRITER(appDataContents);
+    STRING_TO_WRITER(headRevisionId);
+    INSTANCE_VECTOR_TO_WRITER(properties);
+    INSTANCE_TO_WRITER(imageMediaMetadata);
+    writer.end_object();
+}
+
+
+#define GFILE_FIELD_NAME(name) #name,
+
+static const char* GFILE_FIELD_NAMES[] = {
+    GFILE_FIELDS(GFILE_FIELD_NAME)
+};
+
+const char* GFileProjection::name(GFileField field) {
+    return GFILE_FIELD_NAMES[field];
+}
+
+static std::map<std::string, int> build_gfile_field_index() {
+    std::map<std::string, int> rst;
+    for (int i = 0; i < GF_FIELD_COUNT; i ++) {
+        rst[GFILE_FIELD_NAMES[i]] = i;
+    }
+    return rst;
+}
+
+int GFileProjection::field(const std::string& name) {
+    static const std::map<std::string, int> fields = build_gfile_field_index();
+    std::map<std::string, int>::const_iterator iter = fields.find(name);
+    if (iter == fields.end()) {
+        return -1;
+    }
+    return iter->second;
+}
+
+std::string GFileProjection::to_fields() const {
+    std::string rst;
+    for (int i = 0; i < GF_FIELD_COUNT; i ++) {
+        if ((_mask & FIELD_BIT(i)) == 0) continue;
+        if (rst.size() != 0) rst += ",";
+        rst += GFILE_FIELD_NAMES[i];
+    }
+    return rst;
+}
+
+std::string GFileProjection::to_list_fields() const {
+    return "nextPageToken,items(" + to_fields() + ")";
+}
 
 GFileList::GFileList() {
     etag = selfLink = nextPageToken = nextLink = "";
@@ -529,6 +1265,28 @@ void GFileList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GFile, items);
 }
 
+void GFileList::from_json(JsonReader& reader) {
+    from_json(reader, GFILE_ALL_FIELDS);
+}
+
+void GFileList::from_json(JsonReader& reader, FieldMask projection) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(nextPageToken);
+    STRING_FROM_READER(nextLink);
+    if (_key == "items") {
+        if (reader.begin_array()) {
+            while (reader.next_item()) {
+                items.push_back(GFile());
+                items.back().from_json(reader, projection);
+            }
+        }
+        continue;
+    }
+    READER_END
+}
+
 
 GServiceQuota::GServiceQuota(){
     serviceName = "";
@@ -540,6 +1298,13 @@ void GServiceQuota::from_json(JObject* obj) {
     INT_FROM_JSON(bytesUsed);
 }
 
+void GServiceQuota::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(serviceName);
+    INT_FROM_READER(bytesUsed);
+    READER_END
+}
+
 GFormat::GFormat() {
     source = "";
     targets.clear();
@@ -550,6 +1315,13 @@ void GFormat::from_json(JObject* obj) {
     STRING_VECTOR_FROM_JSON(targets);
 }
 
+void GFormat::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(source);
+    STRING_VECTOR_FROM_READER(targets);
+    READER_END
+}
+
 GRole::GRole() {
     primaryRole = "";
     additionalRoles.clear();
@@ -560,6 +1332,13 @@ void GRole::from_json(JObject* obj) {
     STRING_VECTOR_FROM_JSON(additionalRoles);
 }
 
+void GRole::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(primaryRole);
+    STRING_VECTOR_FROM_READER(additionalRoles);
+    READER_END
+}
+
 GRoleInfo::GRoleInfo() {
     type = "";
     roleSets.clear();
@@ -570,6 +1349,13 @@ void GRoleInfo::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GRole, roleSets);
 }
 
+void GRoleInfo::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(type);
+    INSTANCE_VECTOR_FROM_READER(GRole, roleSets);
+    READER_END
+}
+
 GFeature::GFeature() {
     featureName = "";
     featureRate = 0.0;
@@ -580,6 +1366,13 @@ void GFeature::from_json(JObject* obj) {
     REAL_FROM_JSON(featureRate);
 }
 
+void GFeature::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(featureName);
+    REAL_FROM_READER(featureRate);
+    READER_END
+}
+
 GUploadSize::GUploadSize () {
     type = "";
     size = -1;
@@ -590,6 +1383,13 @@ void GUploadSize::from_json(JObject* obj) {
     INT_FROM_JSON(size);
 }
 
+void GUploadSize::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(type);
+    INT_FROM_READER(size);
+    READER_END
+}
+
 GAbout::GAbout() {
     etag = selfLink = name = "";
     quotaBytesTotal = quotaBytesUsed = quotaBytesUsedAggregate = quotaBytesUsedInTrash = -1;
@@ -631,6 +1431,33 @@ void GAbout::from_json(JObject* obj) {
     STRING_FROM_JSON(languageCode);
 }
 
+void GAbout::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(name);
+    INSTANCE_FROM_READER(user);
+    INT_FROM_READER(quotaBytesTotal);
+    INT_FROM_READER(quotaBytesUsed);
+    INT_FROM_READER(quotaBytesUsedAggregate);
+    INT_FROM_READER(quotaBytesUsedInTrash);
+    STRING_FROM_READER(quotaType);
+    INSTANCE_VECTOR_FROM_READER(GServiceQuota,quotaBytesByService);
+    INT_FROM_READER(largestChangedId);
+    INT_FROM_READER(remainingChangeIds);
+    STRING_FROM_READER(rootFolderId);
+    STRING_FROM_READER(domainSharingPolicy);
+    STRING_FROM_READER(permissionId);
+    INSTANCE_VECTOR_FROM_READER(GFormat, importFormats);
+    INSTANCE_VECTOR_FROM_READER(GFormat, exportFormats);
+    INSTANCE_VECTOR_FROM_READER(GRoleInfo, additionalRoleInfo);
+    INSTANCE_VECTOR_FROM_READER(GFeature, features);
+    INSTANCE_VECTOR_FROM_READER(GUploadSize, maxUploadSizes);
+    BOOL_FROM_READER(isCurrentAppInstalled);
+    STRING_FROM_READER(languageCode);
+    READER_END
+}
+
 GChange::GChange() {
     id = fileId = selfLink = "";
     deleted = false;
@@ -645,6 +1472,17 @@ void GChange::from_json(JObject* obj) {
     INSTANCE_FROM_JSON(file);
 }
 
+void GChange::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(fileId);
+    STRING_FROM_READER(selfLink);
+    BOOL_FROM_READER(deleted);
+    TIME_FROM_READER(modificationDate);
+    INSTANCE_FROM_READER(file);
+    READER_END
+}
+
 GChangeList::GChangeList() {
     etag = selfLink = nextPageToken = nextLink = "";
     largestChangeId = -1;
@@ -660,7 +1498,21 @@ void GChangeList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GChange, items);
 }
 
+void GChangeList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(nextPageToken);
+    STRING_FROM_READER(nextLink);
+    INT_FROM_READER(largestChangeId);
+    INSTANCE_VECTOR_FROM_READER(GChange, items);
+    READER_END
+}
+
+const char* const GChildren::FIELD_NAMES[] = { GCHILDREN_FIELDS(FIELD_NAME) };
+
 GChildren::GChildren() {
+    _fields = 0;
     id = selfLink = childLink = "";
 }
 
@@ -670,6 +1522,14 @@ void GChildren::from_json(JObject* obj) {
     STRING_FROM_JSON(childLink);
 }
 
+void GChildren::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(childLink);
+    READER_END
+}
+
 JObject* GChildren::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(id);
@@ -678,6 +1538,14 @@ JObject* GChildren::to_json() {
     return obj;
 }
 
+void GChildren::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(id);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(childLink);
+    writer.end_object();
+}
+
 GChildrenList::GChildrenList() {
     etag = selfLink = nextPageToken = nextLink = "";
     items.clear();
@@ -691,7 +1559,20 @@ void GChildrenList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GChildren, items);
 }
 
+void GChildrenList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(nextPageToken);
+    STRING_FROM_READER(nextLink);
+    INSTANCE_VECTOR_FROM_READER(GChildren, items);
+    READER_END
+}
+
+const char* const GRevision::FIELD_NAMES[] = { GREVISION_FIELDS(FIELD_NAME) };
+
 GRevision::GRevision() {
+    _fields = 0;
     etag = id = selfLink = mimeType = "";
     pinned = published = publishedAuto = publishedOutsideDomain = false;
     publishedLink = downloadUri = "";
@@ -720,6 +1601,28 @@ void GRevision::from_json(JObject* obj) {
     INT_FROM_JSON(fileSize);
 }
 
+void GRevision::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(mimeType);
+    TIME_FROM_READER(modifiedDate);
+    BOOL_FROM_READER(pinned);
+    BOOL_FROM_READER(published);
+    STRING_FROM_READER(publishedLink);
+    BOOL_FROM_READER(publishedAuto);
+    BOOL_FROM_READER(publishedOutsideDomain);
+    STRING_FROM_READER(downloadUri);
+    STRING_MAP_FROM_READER(exportLinks);
+    STRING_FROM_READER(lastModifyingUserName);
+    INSTANCE_FROM_READER(lastModifyingUser);
+    STRING_FROM_READER(originalFilename);
+    STRING_FROM_READER(md5Checksum);
+    INT_FROM_READER(fileSize);
+    READER_END
+}
+
 JObject* GRevision::to_json() {
     JObject * obj = new JObject();
     STRING_TO_JSON(etag);
@@ -742,6 +1645,28 @@ JObject* GRevision::to_json() {
     return obj;
 }
 
+void GRevision::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(etag);
+    STRING_TO_WRITER(id);
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(mimeType);
+    TIME_TO_WRITER(modifiedDate);
+    BOOL_TO_WRITER(pinned);
+    BOOL_TO_WRITER(published);
+    STRING_TO_WRITER(publishedLink);
+    BOOL_TO_WRITER(publishedAuto);
+    BOOL_TO_WRITER(publishedOutsideDomain);
+    STRING_TO_WRITER(downloadUri);
+    STRING_MAP_TO_WRITER(exportLinks);
+    STRING_TO_WRITER(lastModifyingUserName);
+    INSTANCE_TO_WRITER(lastModifyingUser);
+    STRING_TO_WRITER(originalFilename);
+    STRING_TO_WRITER(md5Checksum);
+    INT_TO_WRITER(fileSize);
+    writer.end_object();
+}
+
 GRevisionList::GRevisionList() {
     etag = selfLink = "";
     items.clear();
@@ -753,6 +1678,14 @@ void GRevisionList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GRevision, items);
 }
 
+void GRevisionList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    INSTANCE_VECTOR_FROM_READER(GRevision, items);
+    READER_END
+}
+
 GAppIcon::GAppIcon() {
     category = "";
     size = -1;
@@ -765,6 +1698,14 @@ void GAppIcon::from_json(JObject* obj) {
     STRING_FROM_JSON(iconUrl);
 }
 
+void GAppIcon::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(category);
+    INT_FROM_READER(size);
+    STRING_FROM_READER(iconUrl);
+    READER_END
+}
+
 GApp::GApp() {
     id = name = objectType = shortDescription = longDescription = "";
     supportsCreate = supportsImport = supportsMultiOpen = supportsOfflineCreate = false;
@@ -803,6 +1744,34 @@ void GApp::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GAppIcon, icons);
 }
 
+void GApp::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(id);
+    STRING_FROM_READER(name);
+    STRING_FROM_READER(objectType);
+    STRING_FROM_READER(shortDescription);
+    STRING_FROM_READER(longDescription);
+    BOOL_FROM_READER(supportsCreate);
+    BOOL_FROM_READER(supportsImport);
+    BOOL_FROM_READER(supportsMultiOpen);
+    BOOL_FROM_READER(supportsOfflineCreate);
+    BOOL_FROM_READER(installed);
+    BOOL_FROM_READER(authorized);
+    BOOL_FROM_READER(hasDriveWideScope);
+    BOOL_FROM_READER(useByDefault);
+    STRING_FROM_READER(productUrl);
+    STRING_FROM_READER(productId);
+    STRING_FROM_READER(openUrlTemplate);
+    STRING_FROM_READER(createUrl);
+    STRING_FROM_READER(createInFolderTemplate);
+    STRING_VECTOR_FROM_READER(primaryMimeTypes);
+    STRING_VECTOR_FROM_READER(secondaryMimeTypes);
+    STRING_VECTOR_FROM_READER(primaryFileExtensions);
+    STRING_VECTOR_FROM_READER(secondaryFileExtensions);
+    INSTANCE_VECTOR_FROM_READER(GAppIcon, icons);
+    READER_END
+}
+
 GAppList::GAppList() {
     etag = selfLink = "";
     items.clear();
@@ -816,7 +1785,19 @@ void GAppList::from_json(JObject* obj) {
     STRING_VECTOR_FROM_JSON(defaultAppIds);
 }
 
+void GAppList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(etag);
+    STRING_FROM_READER(selfLink);
+    INSTANCE_VECTOR_FROM_READER(GApp, items);
+    STRING_VECTOR_FROM_READER(defaultAppIds);
+    READER_END
+}
+
+const char* const GReply::FIELD_NAMES[] = { GREPLY_FIELDS(FIELD_NAME) };
+
 GReply::GReply() {
+    _fields = 0;
     replyId = htmlContent = content = verb = "";
     deleted = false;
 }
@@ -832,6 +1813,19 @@ void GReply::from_json(JObject* obj) {
     STRING_FROM_JSON(verb);
 }
 
+void GReply::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(replyId);
+    TIME_FROM_READER(createDate);
+    TIME_FROM_READER(modifiedDate);
+    INSTANCE_FROM_READER(author);
+    STRING_FROM_READER(htmlContent);
+    STRING_FROM_READER(content);
+    BOOL_FROM_READER(deleted);
+    STRING_FROM_READER(verb);
+    READER_END
+}
+
 JObject* GReply::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(replyId);
@@ -845,6 +1839,19 @@ JObject* GReply::to_json() {
     return obj;
 }
 
+void GReply::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(replyId);
+    TIME_TO_WRITER(createDate);
+    TIME_TO_WRITER(modifiedDate);
+    INSTANCE_TO_WRITER(author);
+    STRING_TO_WRITER(htmlContent);
+    STRING_TO_WRITER(content);
+    BOOL_TO_WRITER(deleted);
+    STRING_TO_WRITER(verb);
+    writer.end_object();
+}
+
 GReplyList::GReplyList() {
     selfLink = nextPageToken = nextLink = "";
     items.clear();
@@ -857,6 +1864,15 @@ void GReplyList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GReply, items);
 }
 
+void GReplyList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(nextPageToken);
+    STRING_FROM_READER(nextLink);
+    INSTANCE_VECTOR_FROM_READER(GReply, items);
+    READER_END
+}
+
 GCommentContext::GCommentContext() {
     type = value = "";
 }
@@ -866,6 +1882,13 @@ void GCommentContext::from_json(JObject* obj) {
     STRING_FROM_JSON(value);
 }
 
+void GCommentContext::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(type);
+    STRING_FROM_READER(value);
+    READER_END
+}
+
 JObject* GCommentContext::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(type);
@@ -873,7 +1896,17 @@ JObject* GCommentContext::to_json() {
     return obj;
 }
 
+void GCommentContext::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(type);
+    STRING_TO_WRITER(value);
+    writer.end_object();
+}
+
+const char* const GComment::FIELD_NAMES[] = { GCOMMENT_FIELDS(FIELD_NAME) };
+
 GComment::GComment() {
+    _fields = 0;
     selfLink = commentId = htmlContent = content = status = ""; 
     deleted = false;
     anchor = fileId = fileTitle;
@@ -897,6 +1930,25 @@ void GComment::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GReply, replies);
 }
 
+void GComment::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(commentId);
+    TIME_FROM_READER(createdDate);
+    TIME_FROM_READER(modifiedDate);
+    INSTANCE_FROM_READER(author);
+    STRING_FROM_READER(htmlContent);
+    STRING_FROM_READER(content);
+    BOOL_FROM_READER(deleted);
+    STRING_FROM_READER(status);
+    INSTANCE_FROM_READER(context);
+    STRING_FROM_READER(anchor);
+    STRING_FROM_READER(fileId);
+    STRING_FROM_READER(fileTitle);
+    INSTANCE_VECTOR_FROM_READER(GReply, replies);
+    READER_END
+}
+
 JObject* GComment::to_json() {
     JObject* obj = new JObject();
     STRING_TO_JSON(selfLink);
@@ -916,6 +1968,25 @@ JObject* GComment::to_json() {
     return obj;
 }
 
+void GComment::to_json(JsonWriter& writer, FieldMask fields) const {
+    writer.begin_object();
+    STRING_TO_WRITER(selfLink);
+    STRING_TO_WRITER(commentId);
+    TIME_TO_WRITER(createdDate);
+    TIME_TO_WRITER(modifiedDate);
+    INSTANCE_TO_WRITER(author);
+    STRING_TO_WRITER(htmlContent);
+    STRING_TO_WRITER(content);
+    BOOL_TO_WRITER(deleted);
+    STRING_TO_WRITER(status);
+    INSTANCE_TO_WRITER(context);
+    STRING_TO_WRITER(anchor);
+    STRING_TO_WRITER(fileId);
+    STRING_TO_WRITER(fileTitle);
+    INSTANCE_VECTOR_TO_WRITER(replies);
+    writer.end_object();
+}
+
 GCommentList::GCommentList() {
     selfLink = nextPageToken = nextLink = "";
     items.clear();
@@ -928,6 +1999,15 @@ void GCommentList::from_json(JObject* obj) {
     INSTANCE_VECTOR_FROM_JSON(GComment, items);
 }
 
+void GCommentList::from_json(JsonReader& reader) {
+    READER_BEGIN
+    STRING_FROM_READER(selfLink);
+    STRING_FROM_READER(nextPageToken);
+    STRING_FROM_READER(nextLink);
+    INSTANCE_VECTOR_FROM_READER(GComment, items);
+    READER_END
+}
+
 GError::GError() {
     code = -1;
     message = "";
@@ -940,4 +2020,17 @@ void GError::from_json(JObject* obj) {
     STRINGMAP_VECTOR_FROM_JSON(errors);
 }
 
+void GError::from_json(JsonReader& reader) {
+    READER_BEGIN
+    // error responses wrap the fields in an "error" envelope
+    if (_key == "error") {
+        from_json(reader);
+        continue;
+    }
+    STRING_FROM_READER(message);
+    INT_FROM_READER(code);
+    STRINGMAP_VECTOR_FROM_READER(errors);
+    READER_END
+}
+
 }
@@ -0,0 +1,78 @@
+#include "gdrive/itemstream.hpp"
+
+namespace GDRIVE {
+
+ItemSplitter::ItemSplitter() {
+    reset();
+}
+
+void ItemSplitter::reset() {
+    _scan = 0;
+    _depth = 0;
+    _in_string = _escape = false;
+    _key_begin = _key_end = 0;
+    _items_begin = _items_end = std::string::npos;
+    _item_begin = 0;
+}
+
+void ItemSplitter::feed(const std::string& content, std::vector<ItemRange>& ranges) {
+    const char* data = content.data();
+    size_t size = content.size();
+    for (; _scan < size; _scan ++) {
+        char c = data[_scan];
+        if (_in_string) {
+            if (_escape) {
+                _escape = false;
+            } else if (c == '\\') {
+                _escape = true;
+            } else if (c == '"') {
+                _in_string = false;
+                if (_depth == 1) _key_end = _scan;
+            }
+            continue;
+        }
+        bool in_items = has_items() && !complete();
+        switch (c) {
+            case '"':
+                _in_string = true;
+                if (_depth == 1) _key_begin = _scan + 1;
+                break;
+            case '{':
+            case '[':
+                // the last string seen at the top level is the key of this value
+                if (_depth == 1 && c == '[' && !has_items()
+                        && content.compare(_key_begin, _key_end - _key_begin, "items") == 0) {
+                    _items_begin = _scan;
+                } else if (_depth == 2 && in_items && c == '{') {
+                    _item_begin = _scan;
+                }
+                _depth ++;
+                break;
+            case '}':
+            case ']':
+                _depth --;
+                if (_depth == 2 && in_items && c == '}') {
+                    ranges.push_back(ItemRange(_item_begin, _scan + 1 - _item_begin));
+                } else if (_depth == 1 && in_items && c == ']') {
+                    _items_end = _scan + 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::string ItemSplitter::envelope(const std::string& content) const {
+    if (!has_items() || !complete()) {
+        return content;
+    }
+    std::string rst;
+    rst.reserve(content.size() - (_items_end - _items_begin) + 2);
+    rst.append(content, 0, _items_begin);
+    rst.append("[]");
+    rst.append(content, _items_end, std::string::npos);
+    return rst;
+}
+
+}
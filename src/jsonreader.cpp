@@ -0,0 +1,406 @@
+#include "gdrive/jsonreader.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace GDRIVE {
+
+JsonReader::JsonReader()
+    :_begin(NULL), _pos(NULL), _end(NULL), _first(true)
+{
+}
+
+JsonReader::JsonReader(const char* data, size_t size)
+    :_begin(data), _pos(data), _end(data + size), _first(true)
+{
+}
+
+JsonReader::JsonReader(const std::string& content)
+    :_begin(content.data()), _pos(content.data()), _end(content.data() + content.size()), _first(true)
+{
+}
+
+void JsonReader::reset(const char* data, size_t size) {
+    _begin = _pos = data;
+    _end = data + size;
+    _first = true;
+}
+
+void JsonReader::_fail(const char* msg) {
+    throw JsonParseException(msg, (int)position());
+}
+
+void JsonReader::_expect(char c) {
+    _skip_space();
+    if (_pos >= _end || *_pos != c) {
+        std::string msg = "Expected ";
+        msg += c;
+        _fail(msg.c_str());
+    }
+    _pos ++;
+}
+
+void JsonReader::_literal(const char* word) {
+    size_t len = strlen(word);
+    if ((size_t)(_end - _pos) < len || memcmp(_pos, word, len) != 0) {
+        _fail("Invalid literal");
+    }
+    _pos += len;
+}
+
+bool JsonReader::_null() {
+    _skip_space();
+    if (_pos < _end && *_pos == 'n') {
+        _literal("null");
+        return true;
+    }
+    return false;
+}
+
+JsonType JsonReader::peek() {
+    _skip_space();
+    if (_pos >= _end) {
+        return JT_END;
+    }
+    switch (*_pos) {
+        case '{': return JT_OBJECT;
+        case '[': return JT_ARRAY;
+        case '"': return JT_STRING;
+        case 't':
+        case 'f': return JT_BOOL;
+        case 'n': return JT_NULL;
+        default: return JT_NUMBER;
+    }
+}
+
+bool JsonReader::begin_object() {
+    if (_null()) {
+        return false;
+    }
+    _expect('{');
+    _first = true;
+    return true;
+}
+
+bool JsonReader::begin_array() {
+    if (_null()) {
+        return false;
+    }
+    _expect('[');
+    _first = true;
+    return true;
+}
+
+bool JsonReader::next_key(std::string& key) {
+    _skip_space();
+    if (_pos < _end && *_pos == '}') {
+        _pos ++;
+        _first = false;
+        return false;
+    }
+    if (!_first) {
+        _expect(',');
+        _skip_space();
+    }
+    _first = false;
+    if (_pos >= _end || *_pos != '"') {
+        _fail("Expected key");
+    }
+    _string(key);
+    _expect(':');
+    return true;
+}
+
+bool JsonReader::next_key() {
+    return next_key(_key);
+}
+
+bool JsonReader::next_item() {
+    _skip_space();
+    if (_pos < _end && *_pos == ']') {
+        _pos ++;
+        _first = false;
+        return false;
+    }
+    if (!_first) {
+        _expect(',');
+    }
+    _first = false;
+    return true;
+}
+
+static void append_utf8(std::string& value, unsigned int cp) {
+    if (cp < 0x80) {
+        value += (char)cp;
+    } else if (cp < 0x800) {
+        value += (char)(0xC0 | (cp >> 6));
+        value += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        value += (char)(0xE0 | (cp >> 12));
+        value += (char)(0x80 | ((cp >> 6) & 0x3F));
+        value += (char)(0x80 | (cp & 0x3F));
+    } else {
+        value += (char)(0xF0 | (cp >> 18));
+        value += (char)(0x80 | ((cp >> 12) & 0x3F));
+        value += (char)(0x80 | ((cp >> 6) & 0x3F));
+        value += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+static int hex4(const char* p) {
+    int rst = 0;
+    for (int i = 0; i < 4; i ++) {
+        char c = p[i];
+        rst <<= 4;
+        if (c >= '0' && c <= '9') rst |= c - '0';
+        else if (c >= 'a' && c <= 'f') rst |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') rst |= c - 'A' + 10;
+        else return -1;
+    }
+    return rst;
+}
+
+void JsonReader::_string(std::string& value) {
+    // cursor is on the opening quote
+    _pos ++;
+    const char* start = _pos;
+    while (_pos < _end && *_pos != '"' && *_pos != '\\') {
+        _pos ++;
+    }
+    value.assign(start, _pos - start);
+    while (_pos < _end && *_pos == '\\') {
+        if (_end - _pos < 2) {
+            _fail("Unterminated escape");
+        }
+        char c = _pos[1];
+        _pos += 2;
+        switch (c) {
+            case '"': value += '"'; break;
+            case '\\': value += '\\'; break;
+            case '/': value += '/'; break;
+            case 'b': value += '\b'; break;
+            case 'f': value += '\f'; break;
+            case 'n': value += '\n'; break;
+            case 'r': value += '\r'; break;
+            case 't': value += '\t'; break;
+            case 'u': {
+                if (_end - _pos < 4) {
+                    _fail("Invalid unicode escape");
+                }
+                int cp = hex4(_pos);
+                if (cp < 0) {
+                    _fail("Invalid unicode escape");
+                }
+                _pos += 4;
+                if (cp >= 0xD800 && cp < 0xDC00 && _end - _pos >= 6 && _pos[0] == '\\' && _pos[1] == 'u') {
+                    int low = hex4(_pos + 2);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        _pos += 6;
+                    }
+                }
+                append_utf8(value, (unsigned int)cp);
+                break;
+            }
+            default:
+                _fail("Invalid escape");
+        }
+        start = _pos;
+        while (_pos < _end && *_pos != '"' && *_pos != '\\') {
+            _pos ++;
+        }
+        value.append(start, _pos - start);
+    }
+    if (_pos >= _end) {
+        _fail("Unterminated string");
+    }
+    _pos ++;
+}
+
+void JsonReader::_skip_string() {
+    _pos ++;
+    while (_pos < _end) {
+        const char* quote = (const char*)memchr(_pos, '"', _end - _pos);
+        if (quote == NULL) {
+            break;
+        }
+        // an escaped quote is preceded by an odd number of backslashes
+        const char* back = quote;
+        while (back > _pos && back[-1] == '\\') back --;
+        _pos = quote + 1;
+        if (((quote - back) & 1) == 0) {
+            return;
+        }
+    }
+    _fail("Unterminated string");
+}
+
+void JsonReader::read_string(std::string& value) {
+    if (_null()) {
+        return;
+    }
+    if (_pos >= _end || *_pos != '"') {
+        _fail("Expected string");
+    }
+    _string(value);
+}
+
+bool JsonReader::read_string_span(const char*& data, size_t& size) {
+    if (_null()) {
+        return false;
+    }
+    if (_pos >= _end || *_pos != '"') {
+        _fail("Expected string");
+    }
+    const char* start = _pos + 1;
+    const char* stop = start;
+    while (stop < _end && *stop != '"' && *stop != '\\') {
+        stop ++;
+    }
+    if (stop < _end && *stop == '"') {
+        data = start;
+        size = stop - start;
+        _pos = stop + 1;
+        return true;
+    }
+    _string(_scratch);
+    data = _scratch.data();
+    size = _scratch.size();
+    return true;
+}
+
+void JsonReader::read_bool(bool& value) {
+    if (_null()) {
+        return;
+    }
+    if (_pos < _end && *_pos == 't') {
+        _literal("true");
+        value = true;
+    } else if (_pos < _end && *_pos == 'f') {
+        _literal("false");
+        value = false;
+    } else {
+        _fail("Expected boolean");
+    }
+}
+
+bool JsonReader::_number_span(const char*& start, const char*& end) {
+    // int64 fields arrive quoted, so accept both forms
+    bool quoted = _pos < _end && *_pos == '"';
+    if (quoted) _pos ++;
+    start = _pos;
+    bool integral = true;
+    while (_pos < _end) {
+        char c = *_pos;
+        if (c >= '0' && c <= '9') {
+        } else if (c == '-' || c == '+') {
+        } else if (c == '.' || c == 'e' || c == 'E') {
+            integral = false;
+        } else {
+            break;
+        }
+        _pos ++;
+    }
+    end = _pos;
+    if (start == end) {
+        _fail("Expected number");
+    }
+    if (quoted) {
+        if (_pos >= _end || *_pos != '"') {
+            _fail("Expected number");
+        }
+        _pos ++;
+    }
+    return integral;
+}
+
+long long JsonReader::_integer() {
+    const char* start;
+    const char* end;
+    if (!_number_span(start, end)) {
+        char tmp[64];
+        size_t len = end - start < 63 ? end - start : 63;
+        memcpy(tmp, start, len);
+        tmp[len] = '\0';
+        return (long long)strtod(tmp, NULL);
+    }
+    bool negative = *start == '-';
+    if (negative || *start == '+') start ++;
+    long long rst = 0;
+    for (; start < end; start ++) {
+        if (*start < '0' || *start > '9') {
+            _fail("Invalid integer");
+        }
+        rst = rst * 10 + (*start - '0');
+    }
+    return negative ? -rst : rst;
+}
+
+void JsonReader::read_number(int& value) {
+    if (!_null()) value = (int)_integer();
+}
+
+void JsonReader::read_number(long& value) {
+    if (!_null()) value = (long)_integer();
+}
+
+void JsonReader::read_number(long long& value) {
+    if (!_null()) value = _integer();
+}
+
+void JsonReader::read_number(double& value) {
+    if (_null()) {
+        return;
+    }
+    const char* start;
+    const char* end;
+    _number_span(start, end);
+    char tmp[64];
+    size_t len = end - start < 63 ? end - start : 63;
+    memcpy(tmp, start, len);
+    tmp[len] = '\0';
+    value = strtod(tmp, NULL);
+}
+
+void JsonReader::skip() {
+    _skip_space();
+    if (_pos >= _end) {
+        _fail("Unexpected end of input");
+    }
+    char c = *_pos;
+    if (c == '"') {
+        _skip_string();
+    } else if (c == '{' || c == '[') {
+        int depth = 0;
+        while (_pos < _end) {
+            c = *_pos;
+            if (c == '"') {
+                _skip_string();
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth ++;
+            } else if (c == '}' || c == ']') {
+                if (-- depth == 0) {
+                    _pos ++;
+                    _first = false;
+                    return;
+                }
+            }
+            _pos ++;
+        }
+        _fail("Unterminated container");
+    } else if (c == 't') {
+        _literal("true");
+    } else if (c == 'f') {
+        _literal("false");
+    } else if (c == 'n') {
+        _literal("null");
+    } else {
+        const char* start;
+        const char* end;
+        _number_span(start, end);
+    }
+}
+
+}
@@ -0,0 +1,129 @@
+#include "gdrive/jsonwriter.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace GDRIVE {
+
+JsonWriter::JsonWriter()
+    :_after_key(false)
+{
+}
+
+void JsonWriter::reset() {
+    _buf.clear();
+    _first.clear();
+    _after_key = false;
+}
+
+void JsonWriter::_separate() {
+    if (_after_key) {
+        _after_key = false;
+        return;
+    }
+    if (_first.size() == 0) {
+        return;
+    }
+    if (_first.back()) {
+        _first.back() = false;
+    } else {
+        _buf += ',';
+    }
+}
+
+void JsonWriter::begin_object() {
+    _separate();
+    _buf += '{';
+    _first.push_back(true);
+}
+
+void JsonWriter::end_object() {
+    _buf += '}';
+    _first.pop_back();
+}
+
+void JsonWriter::begin_array() {
+    _separate();
+    _buf += '[';
+    _first.push_back(true);
+}
+
+void JsonWriter::end_array() {
+    _buf += ']';
+    _first.pop_back();
+}
+
+void JsonWriter::key(const std::string& name) {
+    _separate();
+    _string(name.data(), name.size());
+    _buf += ':';
+    _after_key = true;
+}
+
+void JsonWriter::_string(const char* data, size_t size) {
+    static const char* HEX = "0123456789abcdef";
+    _buf += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < size; i ++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        _buf.append(data + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"': _buf += "\\\""; break;
+            case '\\': _buf += "\\\\"; break;
+            case '\n': _buf += "\\n"; break;
+            case '\r': _buf += "\\r"; break;
+            case '\t': _buf += "\\t"; break;
+            case '\b': _buf += "\\b"; break;
+            case '\f': _buf += "\\f"; break;
+            default:
+                _buf += "\\u00";
+                _buf += HEX[c >> 4];
+                _buf += HEX[c & 0xF];
+        }
+    }
+    _buf.append(data + start, size - start);
+    _buf += '"';
+}
+
+void JsonWriter::value(const std::string& value) {
+    _separate();
+    _string(value.data(), value.size());
+}
+
+void JsonWriter::value(const char* value) {
+    _separate();
+    _string(value, strlen(value));
+}
+
+void JsonWriter::value(bool value) {
+    _separate();
+    _buf += value ? "true" : "false";
+}
+
+void JsonWriter::value(int value) {
+    this->value((long long)value);
+}
+
+void JsonWriter::value(long value) {
+    this->value((long long)value);
+}
+
+void JsonWriter::value(long long value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), "%lld", value);
+    _separate();
+    _buf.append(tmp, len);
+}
+
+void JsonWriter::value(double value) {
+    char tmp[32];
+    int len = snprintf(tmp, sizeof(tmp), "%.17g", value);
+    _separate();
+    _buf.append(tmp, len);
+}
+
+}
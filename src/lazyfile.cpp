@@ -0,0 +1,164 @@
+#include "gdrive/lazyfile.hpp"
+
+#include <string.h>
+
+namespace GDRIVE {
+
+#define LAZY_READER(field) \
+    if (_offsets[field] == ABSENT) return; \
+    JsonReader reader(_raw.data() + _offsets[field], _raw.size() - _offsets[field]);
+
+template<class T>
+static void read_instance_vector(JsonReader& reader, std::vector<T>& value) {
+    if (!reader.begin_array()) return;
+    while (reader.next_item()) {
+        value.push_back(T());
+        value.back().from_json(reader);
+    }
+}
+
+LazyGFile::LazyGFile() {
+    memset(_offsets, 0xFF, sizeof(_offsets));
+}
+
+LazyGFile::LazyGFile(const std::string& raw)
+    :_raw(raw)
+{
+    _index();
+}
+
+void LazyGFile::from_json(JsonReader& reader) {
+    // keep the bytes of this object only, the reader may be walking a whole page
+    reader.peek();
+    size_t begin = reader.position();
+    reader.skip();
+    _raw.assign(reader.data() + begin, reader.position() - begin);
+    _index();
+}
+
+void LazyGFile::_index() {
+    memset(_offsets, 0xFF, sizeof(_offsets));
+    JsonReader reader(_raw);
+    if (!reader.begin_object()) return;
+    while (reader.next_key()) {
+        int field = GFileProjection::field(reader.key());
+        if (field >= 0) {
+            reader.peek();
+            _offsets[field] = reader.position();
+        }
+        reader.skip();
+    }
+}
+
+GFile LazyGFile::to_gfile() const {
+    GFile file;
+    JsonReader reader(_raw);
+    file.from_json(reader);
+    return file;
+}
+
+void LazyGFile::_decode(GFileField field, std::string& value) const {
+    LAZY_READER(field)
+    reader.read_string(value);
+}
+
+void LazyGFile::_decode(GFileField field, long& value) const {
+    LAZY_READER(field)
+    reader.read_number(value);
+}
+
+void LazyGFile::_decode(GFileField field, int& value) const {
+    LAZY_READER(field)
+    reader.read_number(value);
+}
+
+void LazyGFile::_decode(GFileField field, bool& value) const {
+    LAZY_READER(field)
+    reader.read_bool(value);
+}
+
+void LazyGFile::_decode(GFileField field, struct tm& value) const {
+    LAZY_READER(field)
+    const char* repr;
+    size_t size;
+    if (reader.read_string_span(repr, size)) {
+        value = time_from_epoch_ms(epoch_ms_from_string(repr, size));
+    }
+}
+
+void LazyGFile::_decode(GFileField field, string_map& value) const {
+    LAZY_READER(field)
+    if (!reader.begin_object()) return;
+    while (reader.next_key()) {
+        reader.read_string(value[reader.key()]);
+    }
+}
+
+void LazyGFile::_decode(GFileField field, std::vector<std::string>& value) const {
+    LAZY_READER(field)
+    if (!reader.begin_array()) return;
+    while (reader.next_item()) {
+        value.push_back("");
+        reader.read_string(value.back());
+    }
+}
+
+void LazyGFile::_decode(GFileField field, GFileLabel& value) const {
+    LAZY_READER(field)
+    value.from_json(reader);
+}
+
+void LazyGFile::_decode(GFileField field, GUser& value) const {
+    LAZY_READER(field)
+    value.from_json(reader);
+}
+
+void LazyGFile::_decode(GFileField field, GPermission& value) const {
+    LAZY_READER(field)
+    value.from_json(reader);
+}
+
+void LazyGFile::_decode(GFileField field, GImageMediaMetaData& value) const {
+    LAZY_READER(field)
+    value.from_json(reader);
+}
+
+void LazyGFile::_decode(GFileField field, std::vector<GParent>& value) const {
+    LAZY_READER(field)
+    read_instance_vector(reader, value);
+}
+
+void LazyGFile::_decode(GFileField field, std::vector<GPermission>& value) const {
+    LAZY_READER(field)
+    read_instance_vector(reader, value);
+}
+
+void LazyGFile::_decode(GFileField field, std::vector<GUser>& value) const {
+    LAZY_READER(field)
+    read_instance_vector(reader, value);
+}
+
+void LazyGFile::_decode(GFileField field, std::vector<GProperty>& value) const {
+    LAZY_READER(field)
+    read_instance_vector(reader, value);
+}
+
+LazyFileList::LazyFileList() {
+    etag = selfLink = nextPageToken = nextLink = "";
+    items.clear();
+}
+
+void LazyFileList::from_json(JsonReader& reader) {
+    if (!reader.begin_object()) return;
+    while (reader.next_key()) {
+        const std::string& key = reader.key();
+        if (key == "etag") reader.read_string(etag);
+        else if (key == "selfLink") reader.read_string(selfLink);
+        else if (key == "nextPageToken") reader.read_string(nextPageToken);
+        else if (key == "nextLink") reader.read_string(nextLink);
+        else if (key == "items") read_instance_vector(reader, items);
+        else reader.skip();
+    }
+}
+
+}
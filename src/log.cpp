@@ -0,0 +1,231 @@
+#include "gdrive/log.hpp"
+#include "gdrive/gitem.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+namespace GDRIVE {
+
+static const char* const LEVEL_NAMES[] = {
+    "debug", "info", "warn", "error"
+};
+
+AsyncLog::AsyncLog()
+    :_tail(0), _head(0), _written(0), _dropped(0), _level(GDRIVE_LOG_LEVEL), _stop(false),
+    _file(stderr), _function(NULL), _context(NULL), _sleeping(false)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("AsyncLog", L_DEBUG)
+#endif
+    _slots = new Slot[LOG_RING_SIZE];
+    for (unsigned long i = 0; i < LOG_RING_SIZE; i ++) {
+        _slots[i].sequence = i;
+    }
+    pthread_mutex_init(&_output_lock, NULL);
+    pthread_mutex_init(&_wake_lock, NULL);
+    pthread_cond_init(&_wake, NULL);
+    pthread_cond_init(&_drained, NULL);
+    pthread_create(&_writer, NULL, _write_loop, this);
+}
+
+AsyncLog::~AsyncLog() {
+    pthread_mutex_lock(&_wake_lock);
+    _stop = true;
+    pthread_cond_signal(&_wake);
+    pthread_mutex_unlock(&_wake_lock);
+    pthread_join(_writer, NULL);
+    pthread_cond_destroy(&_drained);
+    pthread_cond_destroy(&_wake);
+    pthread_mutex_destroy(&_wake_lock);
+    pthread_mutex_destroy(&_output_lock);
+    delete [] _slots;
+}
+
+static void flush_at_exit() {
+    AsyncLog::shared().flush();
+}
+
+static AsyncLog* create_shared() {
+    AsyncLog* log = new AsyncLog();
+    atexit(flush_at_exit);
+    return log;
+}
+
+AsyncLog& AsyncLog::shared() {
+    // never destroyed, records logged late in exit are still written
+    static AsyncLog* log = create_shared();
+    return *log;
+}
+
+void AsyncLog::log(int level, unsigned long request_id, const char* endpoint, int status, const char* format, ...) {
+    if (level < _level) {
+        return;
+    }
+    // claim the slot at _tail; its sequence equals the position once the
+    // writer has handed it back
+    unsigned long pos = _tail;
+    Slot* slot;
+    while (true) {
+        slot = &_slots[pos & (LOG_RING_SIZE - 1)];
+        long diff = (long)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__sync_bool_compare_and_swap(&_tail, pos, pos + 1)) {
+                break;
+            }
+            pos = _tail;
+        } else if (diff < 0) {
+            __sync_fetch_and_add(&_dropped, 1);
+            return;
+        } else {
+            pos = _tail;
+        }
+    }
+
+    LogRecord& record = slot->record;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    record.level = level;
+    record.time_ms = (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    record.request_id = request_id;
+    record.status = status;
+    record.endpoint[0] = '\0';
+    if (endpoint != NULL) {
+        strncpy(record.endpoint, endpoint, LOG_ENDPOINT_SIZE - 1);
+        record.endpoint[LOG_ENDPOINT_SIZE - 1] = '\0';
+    }
+    va_list args;
+    va_start(args, format);
+    vsnprintf(record.message, LOG_MESSAGE_SIZE, format, args);
+    va_end(args);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    // pairs with the fence in _write_loop: either the writer sees this
+    // record before it sleeps or this sees it sleeping and wakes it
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (_sleeping) {
+        pthread_mutex_lock(&_wake_lock);
+        pthread_cond_signal(&_wake);
+        pthread_mutex_unlock(&_wake_lock);
+    }
+}
+
+void AsyncLog::set_output(FILE* file) {
+    pthread_mutex_lock(&_output_lock);
+    _file = file;
+    _function = NULL;
+    pthread_mutex_unlock(&_output_lock);
+}
+
+void AsyncLog::set_function(LogFunction function, void* context) {
+    pthread_mutex_lock(&_output_lock);
+    _function = function;
+    _context = context;
+    pthread_mutex_unlock(&_output_lock);
+}
+
+void AsyncLog::flush() {
+    unsigned long target = _tail;
+    pthread_mutex_lock(&_wake_lock);
+    while (_written < target) {
+        pthread_cond_wait(&_drained, &_wake_lock);
+    }
+    pthread_mutex_unlock(&_wake_lock);
+}
+
+void AsyncLog::format(const LogRecord& record, char* buffer, size_t size) {
+    std::string ts = epoch_ms_to_string(record.time_ms);
+    const char* level = record.level >= 0 && record.level < 4 ? LEVEL_NAMES[record.level] : "?";
+    int n = snprintf(buffer, size, "ts=%s level=%s", ts.c_str(), level);
+    if (record.request_id != 0 && n < (int)size) {
+        n += snprintf(buffer + n, size - n, " req=%lu", record.request_id);
+    }
+    if (record.endpoint[0] != '\0' && n < (int)size) {
+        n += snprintf(buffer + n, size - n, " endpoint=%s", record.endpoint);
+    }
+    if (record.status != 0 && n < (int)size) {
+        n += snprintf(buffer + n, size - n, " status=%d", record.status);
+    }
+    if (n + 7 >= (int)size) {
+        return;
+    }
+    // the message is quoted, messages written for CLOG end in a newline
+    memcpy(buffer + n, " msg=\"", 6);
+    n += 6;
+    for (const char* p = record.message; *p != '\0' && n + 3 < (int)size; p ++) {
+        if (*p == '\n' && p[1] == '\0') {
+            break;
+        } else if (*p == '"' || *p == '\\') {
+            buffer[n ++] = '\\';
+            buffer[n ++] = *p;
+        } else if (*p == '\n') {
+            buffer[n ++] = '\\';
+            buffer[n ++] = 'n';
+        } else {
+            buffer[n ++] = *p;
+        }
+    }
+    buffer[n ++] = '"';
+    buffer[n] = '\0';
+}
+
+bool AsyncLog::_ready() {
+    Slot* slot = &_slots[_head & (LOG_RING_SIZE - 1)];
+    return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == _head + 1;
+}
+
+bool AsyncLog::_drain() {
+    bool any = false;
+    pthread_mutex_lock(&_output_lock);
+    while (_ready()) {
+        Slot* slot = &_slots[_head & (LOG_RING_SIZE - 1)];
+        if (_function != NULL) {
+            _function(slot->record, _context);
+        } else if (_file != NULL) {
+            char line[LOG_MESSAGE_SIZE * 2 + 128];
+            format(slot->record, line, sizeof(line));
+            fputs(line, _file);
+            fputc('\n', _file);
+        }
+        // hand the slot back for the lap after this one
+        __atomic_store_n(&slot->sequence, _head + LOG_RING_SIZE, __ATOMIC_RELEASE);
+        _head ++;
+        _written = _head;
+        any = true;
+    }
+    if (any && _function == NULL && _file != NULL) {
+        fflush(_file);
+    }
+    pthread_mutex_unlock(&_output_lock);
+    if (any) {
+        pthread_mutex_lock(&_wake_lock);
+        pthread_cond_broadcast(&_drained);
+        pthread_mutex_unlock(&_wake_lock);
+    }
+    return any;
+}
+
+void* AsyncLog::_write_loop(void* self) {
+    AsyncLog* log = (AsyncLog*)self;
+    while (true) {
+        if (log->_drain()) {
+            continue;
+        }
+        pthread_mutex_lock(&log->_wake_lock);
+        if (log->_stop) {
+            pthread_mutex_unlock(&log->_wake_lock);
+            break;
+        }
+        log->_sleeping = true;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (!log->_ready()) {
+            pthread_cond_wait(&log->_wake, &log->_wake_lock);
+        }
+        log->_sleeping = false;
+        pthread_mutex_unlock(&log->_wake_lock);
+    }
+    log->_drain();
+    return NULL;
+}
+
+}
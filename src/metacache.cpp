@@ -0,0 +1,632 @@
+#include "gdrive/metacache.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <ctype.h>
+
+namespace GDRIVE {
+
+enum QueryKind {
+    QK_AND,
+    QK_OR,
+    QK_NOT,
+    QK_MIMETYPE,
+    QK_TITLE_CONTAINS,
+    QK_TITLE,
+    QK_MODIFIED,
+    QK_PARENT,
+    QK_TRASHED
+};
+
+enum QueryOp {
+    QO_EQ,
+    QO_NE,
+    QO_LT,
+    QO_LE,
+    QO_GT,
+    QO_GE
+};
+
+class QueryNode {
+public:
+    QueryNode(QueryKind k)
+        :kind(k), op(QO_EQ), time(0), flag(false) {}
+    ~QueryNode() {
+        for (int i = 0; i < children.size(); i ++) {
+            delete children[i];
+        }
+    }
+    // predicates served by an index go first in a conjunction
+    bool indexed() const {
+        return (kind == QK_MIMETYPE && op == QO_EQ) || kind == QK_PARENT
+            || (kind == QK_MODIFIED && op != QO_NE);
+    }
+
+    QueryKind kind;
+    QueryOp op;
+    std::string value;
+    time_t time;
+    bool flag;
+    std::vector<QueryNode*> children;
+};
+
+static std::string to_lower(const std::string& str) {
+    std::string rst(str);
+    for (int i = 0; i < rst.size(); i ++) {
+        rst[i] = tolower((unsigned char)rst[i]);
+    }
+    return rst;
+}
+
+/*
+ * Recursive descent parser over the q string.
+ */
+class QueryParser {
+public:
+    QueryParser(const std::string& q)
+        :_q(q), _pos(0) {}
+
+    QueryNode* parse() {
+        QueryNode* node = _parse_or();
+        _skip_space();
+        if (_pos != _q.size()) {
+            delete node;
+            throw QueryException("Unexpected trailing input", _pos);
+        }
+        return node;
+    }
+private:
+    const std::string& _q;
+    size_t _pos;
+
+    void _skip_space() {
+        while (_pos < _q.size() && isspace((unsigned char)_q[_pos])) _pos ++;
+    }
+
+    bool _peek_word(const char* word) {
+        _skip_space();
+        size_t len = strlen(word);
+        if (_q.size() - _pos < len || strncasecmp(_q.c_str() + _pos, word, len) != 0) {
+            return false;
+        }
+        if (_pos + len < _q.size() && (isalnum((unsigned char)_q[_pos + len]) || _q[_pos + len] == '_')) {
+            return false;
+        }
+        return true;
+    }
+
+    bool _accept_word(const char* word) {
+        if (_peek_word(word)) {
+            _pos += strlen(word);
+            return true;
+        }
+        return false;
+    }
+
+    void _expect_word(const char* word) {
+        if (!_accept_word(word)) {
+            throw QueryException(std::string("Expected ") + word, _pos);
+        }
+    }
+
+    std::string _string() {
+        _skip_space();
+        if (_pos >= _q.size() || _q[_pos] != '\'') {
+            throw QueryException("Expected quoted string", _pos);
+        }
+        std::string rst;
+        _pos ++;
+        while (_pos < _q.size() && _q[_pos] != '\'') {
+            if (_q[_pos] == '\\' && _pos + 1 < _q.size()) {
+                _pos ++;
+            }
+            rst += _q[_pos ++];
+        }
+        if (_pos >= _q.size()) {
+            throw QueryException("Unterminated string", _pos);
+        }
+        _pos ++;
+        return rst;
+    }
+
+    QueryOp _op() {
+        _skip_space();
+        const char* ops[] = {"!=", "<=", ">=", "=", "<", ">"};
+        QueryOp values[] = {QO_NE, QO_LE, QO_GE, QO_EQ, QO_LT, QO_GT};
+        for (int i = 0; i < 6; i ++) {
+            if (_q.compare(_pos, strlen(ops[i]), ops[i]) == 0) {
+                _pos += strlen(ops[i]);
+                return values[i];
+            }
+        }
+        throw QueryException("Expected comparison operator", _pos);
+    }
+
+    QueryOp _equality() {
+        size_t start = _pos;
+        QueryOp op = _op();
+        if (op != QO_EQ && op != QO_NE) {
+            throw QueryException("Only = and != are supported here", start);
+        }
+        return op;
+    }
+
+    QueryNode* _parse_or() {
+        QueryNode* node = _parse_and();
+        try {
+            while (_accept_word("or")) {
+                if (node->kind != QK_OR) {
+                    QueryNode* parent = new QueryNode(QK_OR);
+                    parent->children.push_back(node);
+                    node = parent;
+                }
+                node->children.push_back(_parse_and());
+            }
+        } catch (QueryException& e) {
+            delete node;
+            throw;
+        }
+        return node;
+    }
+
+    QueryNode* _parse_and() {
+        QueryNode* node = _parse_not();
+        try {
+            while (_accept_word("and")) {
+                if (node->kind != QK_AND) {
+                    QueryNode* parent = new QueryNode(QK_AND);
+                    parent->children.push_back(node);
+                    node = parent;
+                }
+                node->children.push_back(_parse_not());
+            }
+        } catch (QueryException& e) {
+            delete node;
+            throw;
+        }
+        return node;
+    }
+
+    QueryNode* _parse_not() {
+        if (_accept_word("not")) {
+            QueryNode* child = _parse_not();
+            QueryNode* node = new QueryNode(QK_NOT);
+            node->children.push_back(child);
+            return node;
+        }
+        _skip_space();
+        if (_pos < _q.size() && _q[_pos] == '(') {
+            _pos ++;
+            QueryNode* node = _parse_or();
+            _skip_space();
+            if (_pos >= _q.size() || _q[_pos] != ')') {
+                delete node;
+                throw QueryException("Expected )", _pos);
+            }
+            _pos ++;
+            return node;
+        }
+        return _parse_predicate();
+    }
+
+    QueryNode* _parse_predicate() {
+        QueryNode* node;
+        if (_accept_word("mimeType")) {
+            QueryOp op = _equality();
+            std::string value = _string();
+            node = new QueryNode(QK_MIMETYPE);
+            node->op = op;
+            node->value = value;
+        } else if (_accept_word("title")) {
+            if (_accept_word("contains")) {
+                std::string value = _string();
+                node = new QueryNode(QK_TITLE_CONTAINS);
+                node->value = to_lower(value);
+            } else {
+                QueryOp op = _equality();
+                std::string value = _string();
+                node = new QueryNode(QK_TITLE);
+                node->op = op;
+                node->value = value;
+            }
+        } else if (_accept_word("modifiedDate")) {
+            QueryOp op = _op();
+            _skip_space();
+            size_t start = _pos;
+            std::string repr = _string();
+            if (repr.size() < 10) {
+                throw QueryException("Expected RFC 3339 date", start);
+            }
+            node = new QueryNode(QK_MODIFIED);
+            node->op = op;
+            node->time = (time_t)(epoch_ms_from_string(repr) / 1000);
+        } else if (_accept_word("trashed")) {
+            QueryOp op = _equality();
+            bool flag;
+            if (_accept_word("true")) {
+                flag = true;
+            } else if (_accept_word("false")) {
+                flag = false;
+            } else {
+                throw QueryException("Expected true or false", _pos);
+            }
+            node = new QueryNode(QK_TRASHED);
+            node->op = op;
+            node->flag = flag;
+        } else {
+            _skip_space();
+            if (_pos >= _q.size() || _q[_pos] != '\'') {
+                throw QueryException("Unsupported query term", _pos);
+            }
+            std::string value = _string();
+            _expect_word("in");
+            _expect_word("parents");
+            node = new QueryNode(QK_PARENT);
+            node->value = value;
+        }
+        return node;
+    }
+};
+
+/*
+ * Set algebra over sorted slot vectors. Every evaluation is restricted to
+ * the candidates computed so far, which keeps scans and complements small
+ * once an indexed predicate has narrowed a conjunction.
+ */
+static void universe(const std::vector<bool>& live, const std::vector<CacheSlot>* candidates,
+        std::vector<CacheSlot>& out) {
+    if (candidates != NULL) {
+        out = *candidates;
+        return;
+    }
+    out.clear();
+    for (CacheSlot slot = 0; slot < live.size(); slot ++) {
+        if (live[slot]) out.push_back(slot);
+    }
+}
+
+static void restrict_to(const std::set<CacheSlot>& set, const std::vector<CacheSlot>* candidates,
+        std::vector<CacheSlot>& out) {
+    out.clear();
+    if (candidates == NULL) {
+        out.assign(set.begin(), set.end());
+    } else if (candidates->size() * 8 < set.size()) {
+        for (int i = 0; i < candidates->size(); i ++) {
+            if (set.count((*candidates)[i])) out.push_back((*candidates)[i]);
+        }
+    } else {
+        std::set_intersection(set.begin(), set.end(), candidates->begin(), candidates->end(),
+                std::back_inserter(out));
+    }
+}
+
+static void subtract(const std::vector<CacheSlot>& base, const std::vector<CacheSlot>& removed,
+        std::vector<CacheSlot>& out) {
+    out.clear();
+    std::set_difference(base.begin(), base.end(), removed.begin(), removed.end(), std::back_inserter(out));
+}
+
+static bool compare_indexed(const QueryNode* a, const QueryNode* b) {
+    return a->indexed() && !b->indexed();
+}
+
+class QueryEvaluator {
+public:
+    QueryEvaluator(const MetadataCache& cache)
+        :_cache(cache)
+    {
+        _live.resize(cache._entries.size());
+        for (int i = 0; i < cache._entries.size(); i ++) {
+            _live[i] = cache._entries[i].live;
+        }
+    }
+
+    void eval(const QueryNode* node, const std::vector<CacheSlot>* candidates, std::vector<CacheSlot>& out) {
+        std::vector<CacheSlot> tmp;
+        switch (node->kind) {
+        case QK_AND: {
+            std::vector<QueryNode*> order(node->children);
+            std::stable_sort(order.begin(), order.end(), compare_indexed);
+            eval(order[0], candidates, out);
+            for (int i = 1; i < order.size() && out.size() > 0; i ++) {
+                tmp.swap(out);
+                eval(order[i], &tmp, out);
+            }
+            break;
+        }
+        case QK_OR: {
+            out.clear();
+            for (int i = 0; i < node->children.size(); i ++) {
+                std::vector<CacheSlot> part, merged;
+                eval(node->children[i], candidates, part);
+                std::set_union(out.begin(), out.end(), part.begin(), part.end(), std::back_inserter(merged));
+                out.swap(merged);
+            }
+            break;
+        }
+        case QK_NOT: {
+            std::vector<CacheSlot> base;
+            eval(node->children[0], candidates, tmp);
+            universe(_live, candidates, base);
+            subtract(base, tmp, out);
+            break;
+        }
+        case QK_MIMETYPE:
+            _lookup(_cache._by_mimetype, node->value, node->op, candidates, out);
+            break;
+        case QK_PARENT:
+            _lookup(_cache._by_parent, node->value, QO_EQ, candidates, out);
+            break;
+        case QK_TRASHED: {
+            bool want = node->op == QO_EQ ? node->flag : !node->flag;
+            if (want) {
+                restrict_to(_cache._trashed, candidates, out);
+            } else {
+                std::vector<CacheSlot> base;
+                restrict_to(_cache._trashed, candidates, tmp);
+                universe(_live, candidates, base);
+                subtract(base, tmp, out);
+            }
+            break;
+        }
+        case QK_MODIFIED:
+            _range(node, candidates, out);
+            break;
+        case QK_TITLE_CONTAINS:
+        case QK_TITLE: {
+            std::vector<CacheSlot> base;
+            universe(_live, candidates, base);
+            out.clear();
+            for (int i = 0; i < base.size(); i ++) {
+                const MetadataCache::Entry& entry = _cache._entries[base[i]];
+                bool match;
+                if (node->kind == QK_TITLE_CONTAINS) {
+                    match = entry.title_lower.find(node->value) != std::string::npos;
+                } else {
+                    GFile& file = const_cast<GFile&>(entry.file);
+                    match = (file.get_title() == node->value) == (node->op == QO_EQ);
+                }
+                if (match) out.push_back(base[i]);
+            }
+            break;
+        }
+        }
+    }
+private:
+    const MetadataCache& _cache;
+    std::vector<bool> _live;
+
+    void _lookup(const std::unordered_map<std::string, std::set<CacheSlot> >& index,
+            const std::string& key, QueryOp op, const std::vector<CacheSlot>* candidates,
+            std::vector<CacheSlot>& out) {
+        std::vector<CacheSlot> matched;
+        std::unordered_map<std::string, std::set<CacheSlot> >::const_iterator iter = index.find(key);
+        if (iter != index.end()) {
+            restrict_to(iter->second, candidates, matched);
+        }
+        if (op == QO_EQ) {
+            out.swap(matched);
+        } else {
+            std::vector<CacheSlot> base;
+            universe(_live, candidates, base);
+            subtract(base, matched, out);
+        }
+    }
+
+    void _range(const QueryNode* node, const std::vector<CacheSlot>* candidates, std::vector<CacheSlot>& out) {
+        const std::multimap<time_t, CacheSlot>& index = _cache._by_modified;
+        std::multimap<time_t, CacheSlot>::const_iterator begin = index.begin();
+        std::multimap<time_t, CacheSlot>::const_iterator end = index.end();
+        switch (node->op) {
+        case QO_LT: end = index.lower_bound(node->time); break;
+        case QO_LE: end = index.upper_bound(node->time); break;
+        case QO_GT: begin = index.upper_bound(node->time); break;
+        case QO_GE: begin = index.lower_bound(node->time); break;
+        case QO_EQ:
+        case QO_NE:
+            begin = index.lower_bound(node->time);
+            end = index.upper_bound(node->time);
+            break;
+        }
+        std::vector<CacheSlot> matched;
+        for (; begin != end; begin ++) {
+            matched.push_back(begin->second);
+        }
+        std::sort(matched.begin(), matched.end());
+        if (candidates != NULL) {
+            std::vector<CacheSlot> narrowed;
+            std::set_intersection(matched.begin(), matched.end(), candidates->begin(), candidates->end(),
+                    std::back_inserter(narrowed));
+            matched.swap(narrowed);
+        }
+        if (node->op == QO_NE) {
+            std::vector<CacheSlot> base;
+            universe(_live, candidates, base);
+            subtract(base, matched, out);
+        } else {
+            out.swap(matched);
+        }
+    }
+};
+
+LocalQuery::LocalQuery(const std::string& q) {
+    QueryParser parser(q);
+    _root = parser.parse();
+}
+
+LocalQuery::~LocalQuery() {
+    delete _root;
+}
+
+std::vector<CacheSlot> LocalQuery::evaluate(const MetadataCache& cache) const {
+    QueryEvaluator evaluator(cache);
+    std::vector<CacheSlot> rst;
+    evaluator.eval(_root, NULL, rst);
+    return rst;
+}
+
+MetadataCache::MetadataCache() {
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("MetadataCache", L_DEBUG)
+#endif
+}
+
+void MetadataCache::_index(CacheSlot slot) {
+    Entry& entry = _entries[slot];
+    GFile& file = entry.file;
+    _by_mimetype[file.get_mimeType()].insert(slot);
+    std::vector<GParent> parents = file.get_parents();
+    for (int i = 0; i < parents.size(); i ++) {
+        _by_parent[parents[i].get_id()].insert(slot);
+        if (parents[i].get_isRoot()) {
+            _by_parent[ROOT_FOLDER_ALIAS].insert(slot);
+        }
+    }
+    _by_modified.insert(std::make_pair(entry.modified, slot));
+    if (file.get_labels().trashed) {
+        _trashed.insert(slot);
+    }
+}
+
+void MetadataCache::_unindex(CacheSlot slot) {
+    Entry& entry = _entries[slot];
+    GFile& file = entry.file;
+
+    std::unordered_map<std::string, std::set<CacheSlot> >::iterator iter = _by_mimetype.find(file.get_mimeType());
+    if (iter != _by_mimetype.end()) {
+        iter->second.erase(slot);
+        if (iter->second.size() == 0) _by_mimetype.erase(iter);
+    }
+
+    std::vector<GParent> parents = file.get_parents();
+    std::vector<std::string> keys;
+    for (int i = 0; i < parents.size(); i ++) {
+        keys.push_back(parents[i].get_id());
+        if (parents[i].get_isRoot()) {
+            keys.push_back(ROOT_FOLDER_ALIAS);
+        }
+    }
+    for (int i = 0; i < keys.size(); i ++) {
+        iter = _by_parent.find(keys[i]);
+        if (iter != _by_parent.end()) {
+            iter->second.erase(slot);
+            if (iter->second.size() == 0) _by_parent.erase(iter);
+        }
+    }
+
+    std::pair<std::multimap<time_t, CacheSlot>::iterator, std::multimap<time_t, CacheSlot>::iterator> range =
+        _by_modified.equal_range(entry.modified);
+    for (std::multimap<time_t, CacheSlot>::iterator m = range.first; m != range.second; m ++) {
+        if (m->second == slot) {
+            _by_modified.erase(m);
+            break;
+        }
+    }
+    _trashed.erase(slot);
+}
+
+void MetadataCache::put(GFile& file) {
+    std::string id = file.get_id();
+    if (id == "") {
+        return;
+    }
+    CacheSlot slot;
+    std::unordered_map<std::string, CacheSlot>::iterator iter = _slots.find(id);
+    if (iter != _slots.end()) {
+        slot = iter->second;
+        _unindex(slot);
+    } else if (_free.size() > 0) {
+        slot = _free.back();
+        _free.pop_back();
+        _slots[id] = slot;
+    } else {
+        slot = (CacheSlot)_entries.size();
+        _entries.push_back(Entry());
+        _slots[id] = slot;
+    }
+
+    Entry& entry = _entries[slot];
+    entry.file = file;
+    entry.title_lower = to_lower(file.get_title());
+    entry.modified = (time_t)(file.get_modifiedDate_ms() / 1000);
+    entry.live = true;
+    _index(slot);
+}
+
+void MetadataCache::put(std::vector<GFile>& files) {
+    for (int i = 0; i < files.size(); i ++) {
+        put(files[i]);
+    }
+}
+
+void MetadataCache::remove(const std::string& id) {
+    std::unordered_map<std::string, CacheSlot>::iterator iter = _slots.find(id);
+    if (iter == _slots.end()) {
+        return;
+    }
+    CacheSlot slot = iter->second;
+    _unindex(slot);
+    _entries[slot] = Entry();
+    _entries[slot].live = false;
+    _free.push_back(slot);
+    _slots.erase(iter);
+}
+
+void MetadataCache::apply(GChange& change) {
+    if (change.get_deleted()) {
+        remove(change.get_fileId());
+        return;
+    }
+    GFile file = change.get_file();
+    put(file);
+}
+
+void MetadataCache::apply(std::vector<GChange>& changes) {
+    for (int i = 0; i < changes.size(); i ++) {
+        apply(changes[i]);
+    }
+}
+
+bool MetadataCache::get(const std::string& id, GFile& file) const {
+    std::unordered_map<std::string, CacheSlot>::const_iterator iter = _slots.find(id);
+    if (iter == _slots.end()) {
+        return false;
+    }
+    file = _entries[iter->second].file;
+    return true;
+}
+
+std::vector<GFile> MetadataCache::query(const std::string& q) const {
+    LocalQuery query(q);
+    std::vector<CacheSlot> slots = query.evaluate(*this);
+    std::vector<GFile> rst;
+    rst.reserve(slots.size());
+    for (int i = 0; i < slots.size(); i ++) {
+        rst.push_back(_entries[slots[i]].file);
+    }
+    return rst;
+}
+
+std::vector<std::string> MetadataCache::query_ids(const std::string& q) const {
+    LocalQuery query(q);
+    std::vector<CacheSlot> slots = query.evaluate(*this);
+    std::vector<std::string> rst;
+    rst.reserve(slots.size());
+    for (int i = 0; i < slots.size(); i ++) {
+        GFile& file = const_cast<GFile&>(_entries[slots[i]].file);
+        rst.push_back(file.get_id());
+    }
+    return rst;
+}
+
+void MetadataCache::clear() {
+    _entries.clear();
+    _free.clear();
+    _slots.clear();
+    _by_mimetype.clear();
+    _by_parent.clear();
+    _by_modified.clear();
+    _trashed.clear();
+}
+
+}
@@ -0,0 +1,321 @@
+#include "gdrive/metrics.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace GDRIVE {
+
+// upper bounds of the latency buckets, in microseconds and as exported
+static const long long BUCKET_BOUNDS[METRICS_BUCKETS] = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 30000000
+};
+static const char* const BUCKET_LABELS[METRICS_BUCKETS + 1] = {
+    "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25", "0.5",
+    "1", "2.5", "5", "10", "30", "+Inf"
+};
+static const char* const CODE_LABELS[6] = {
+    "error", "1xx", "2xx", "3xx", "4xx", "5xx"
+};
+
+// the path segments an API call names after its collection
+static const char* const ACTIONS[] = {
+    "copy", "touch", "trash", "untrash", "watch", NULL
+};
+
+Metrics::Metrics() {
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("Metrics", L_DEBUG)
+#endif
+    pthread_key_create(&_key, _release_shard);
+    pthread_mutex_init(&_lock, NULL);
+    _endpoints.push_back("other");
+}
+
+Metrics::~Metrics() {
+    // no exit handler of a thread may run once the shards are gone
+    pthread_key_delete(_key);
+    for (int i = 0; i < _shards.size(); i ++) {
+        delete _shards[i];
+    }
+    pthread_mutex_destroy(&_lock);
+}
+
+Metrics& Metrics::shared() {
+    // never destroyed, threads may still be recording at exit
+    static Metrics* metrics = new Metrics();
+    return *metrics;
+}
+
+int Metrics::endpoint(const std::string& name) {
+    pthread_mutex_lock(&_lock);
+    int id = 0;
+    for (int i = 0; i < _endpoints.size(); i ++) {
+        if (_endpoints[i] == name) {
+            id = i;
+            break;
+        }
+    }
+    if (id == 0 && name != "other" && _endpoints.size() < METRICS_MAX_ENDPOINTS) {
+        id = _endpoints.size();
+        _endpoints.push_back(name);
+    }
+    pthread_mutex_unlock(&_lock);
+    return id;
+}
+
+Metrics::Shard* Metrics::_shard() {
+    Shard* shard = (Shard*)pthread_getspecific(_key);
+    if (shard == NULL) {
+        pthread_mutex_lock(&_lock);
+        if (_free.size() != 0) {
+            shard = _free.back();
+            _free.pop_back();
+        } else {
+            shard = new Shard();
+            shard->owner = this;
+            _shards.push_back(shard);
+        }
+        pthread_mutex_unlock(&_lock);
+        pthread_setspecific(_key, shard);
+    }
+    return shard;
+}
+
+void Metrics::_release_shard(void* shard) {
+    // runs at thread exit, the counts stay in the shard for export
+    Metrics* metrics = ((Shard*)shard)->owner;
+    pthread_mutex_lock(&metrics->_lock);
+    metrics->_free.push_back((Shard*)shard);
+    pthread_mutex_unlock(&metrics->_lock);
+}
+
+void Metrics::record(int endpoint, int status, const TransferTiming& timing, bool throttled) {
+    if (endpoint < 0 || endpoint >= METRICS_MAX_ENDPOINTS) {
+        endpoint = 0;
+    }
+    EndpointStats& stats = _shard()->endpoints[endpoint];
+    int bucket = 0;
+    while (bucket < METRICS_BUCKETS && timing.total > BUCKET_BOUNDS[bucket]) {
+        bucket ++;
+    }
+    int code = status >= 100 && status < 600 ? status / 100 : 0;
+    __sync_fetch_and_add(&stats.buckets[bucket], 1);
+    __sync_fetch_and_add(&stats.sum, timing.total);
+    __sync_fetch_and_add(&stats.codes[code], 1);
+    __sync_fetch_and_add(&stats.bytes_up, timing.bytes_up);
+    __sync_fetch_and_add(&stats.bytes_down, timing.bytes_down);
+    if (throttled) {
+        __sync_fetch_and_add(&stats.throttled, timing.total);
+    }
+}
+
+void Metrics::record_refresh() {
+    __sync_fetch_and_add(&_shard()->refreshes, 1);
+}
+
+// a label value with backslash, quote and newline escaped
+static std::string label_value(const std::string& value) {
+    std::string rst;
+    for (int i = 0; i < value.size(); i ++) {
+        if (value[i] == '\\' || value[i] == '"') {
+            rst += '\\';
+            rst += value[i];
+        } else if (value[i] == '\n') {
+            rst += "\\n";
+        } else {
+            rst += value[i];
+        }
+    }
+    return rst;
+}
+
+static void append_seconds(std::string& out, unsigned long long us) {
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "%llu.%06llu", us / 1000000, us % 1000000);
+    out.append(tmp);
+}
+
+static void append_count(std::string& out, unsigned long long value) {
+    char tmp[24];
+    snprintf(tmp, sizeof(tmp), "%llu", value);
+    out.append(tmp);
+}
+
+void Metrics::write_prometheus(std::string& out) {
+    pthread_mutex_lock(&_lock);
+    std::vector<EndpointStats> totals(_endpoints.size());
+    memset(&totals[0], 0, totals.size() * sizeof(EndpointStats));
+    unsigned long long refreshes = 0;
+    for (int s = 0; s < _shards.size(); s ++) {
+        const Shard* shard = _shards[s];
+        refreshes += shard->refreshes;
+        for (int e = 0; e < totals.size(); e ++) {
+            const EndpointStats& from = shard->endpoints[e];
+            EndpointStats& to = totals[e];
+            for (int b = 0; b <= METRICS_BUCKETS; b ++) {
+                to.buckets[b] += from.buckets[b];
+            }
+            for (int c = 0; c < 6; c ++) {
+                to.codes[c] += from.codes[c];
+            }
+            to.sum += from.sum;
+            to.bytes_up += from.bytes_up;
+            to.bytes_down += from.bytes_down;
+            to.throttled += from.throttled;
+        }
+    }
+    std::vector<std::string> names(_endpoints.size());
+    for (int e = 0; e < names.size(); e ++) {
+        names[e] = label_value(_endpoints[e]);
+    }
+    pthread_mutex_unlock(&_lock);
+
+    out.append("# HELP gdrive_request_duration_seconds Time of Drive API transfers.\n");
+    out.append("# TYPE gdrive_request_duration_seconds histogram\n");
+    for (int e = 0; e < totals.size(); e ++) {
+        unsigned long long count = 0;
+        for (int b = 0; b <= METRICS_BUCKETS; b ++) {
+            count += totals[e].buckets[b];
+        }
+        if (count == 0) continue;
+        unsigned long long cumulative = 0;
+        for (int b = 0; b <= METRICS_BUCKETS; b ++) {
+            cumulative += totals[e].buckets[b];
+            out.append("gdrive_request_duration_seconds_bucket{endpoint=\"").append(names[e])
+               .append("\",le=\"").append(BUCKET_LABELS[b]).append("\"} ");
+            append_count(out, cumulative);
+            out.append("\n");
+        }
+        out.append("gdrive_request_duration_seconds_sum{endpoint=\"").append(names[e]).append("\"} ");
+        append_seconds(out, totals[e].sum);
+        out.append("\ngdrive_request_duration_seconds_count{endpoint=\"").append(names[e]).append("\"} ");
+        append_count(out, count);
+        out.append("\n");
+    }
+
+    out.append("# HELP gdrive_requests_total Drive API transfers by status class.\n");
+    out.append("# TYPE gdrive_requests_total counter\n");
+    for (int e = 0; e < totals.size(); e ++) {
+        for (int c = 0; c < 6; c ++) {
+            if (totals[e].codes[c] == 0) continue;
+            out.append("gdrive_requests_total{endpoint=\"").append(names[e])
+               .append("\",code=\"").append(CODE_LABELS[c]).append("\"} ");
+            append_count(out, totals[e].codes[c]);
+            out.append("\n");
+        }
+    }
+
+    out.append("# HELP gdrive_transfer_bytes_total Body bytes sent and received.\n");
+    out.append("# TYPE gdrive_transfer_bytes_total counter\n");
+    for (int e = 0; e < totals.size(); e ++) {
+        if (totals[e].bytes_up == 0 && totals[e].bytes_down == 0) continue;
+        out.append("gdrive_transfer_bytes_total{endpoint=\"").append(names[e]).append("\",direction=\"sent\"} ");
+        append_count(out, totals[e].bytes_up);
+        out.append("\ngdrive_transfer_bytes_total{endpoint=\"").append(names[e]).append("\",direction=\"received\"} ");
+        append_count(out, totals[e].bytes_down);
+        out.append("\n");
+    }
+
+    out.append("# HELP gdrive_throttled_seconds_total Time spent on transfers the server rate limited.\n");
+    out.append("# TYPE gdrive_throttled_seconds_total counter\n");
+    for (int e = 0; e < totals.size(); e ++) {
+        if (totals[e].throttled == 0) continue;
+        out.append("gdrive_throttled_seconds_total{endpoint=\"").append(names[e]).append("\"} ");
+        append_seconds(out, totals[e].throttled);
+        out.append("\n");
+    }
+
+    out.append("# HELP gdrive_token_refreshes_total Access token refreshes.\n");
+    out.append("# TYPE gdrive_token_refreshes_total counter\n");
+    out.append("gdrive_token_refreshes_total ");
+    append_count(out, refreshes);
+    out.append("\n");
+}
+
+bool Metrics::dump(const std::string& path) {
+    std::string text;
+    write_prometheus(text);
+    // a scraper never sees a half written file
+    std::string tmp = path + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "w");
+    if (fp == NULL) {
+        CLOG_WARN("Cannot write metrics to %s\n", tmp.c_str());
+        return false;
+    }
+    bool ok = fwrite(text.data(), 1, text.size(), fp) == text.size();
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        CLOG_WARN("Cannot write metrics to %s\n", path.c_str());
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Metrics::export_to(ExportFunction function, void* context) {
+    std::string text;
+    write_prometheus(text);
+    function(text, context);
+}
+
+size_t Metrics::memory_usage() {
+    pthread_mutex_lock(&_lock);
+    size_t rst = sizeof(*this) + _shards.size() * sizeof(Shard);
+    rst += _shards.capacity() * sizeof(Shard*) + _free.capacity() * sizeof(Shard*);
+    rst += _endpoints.capacity() * sizeof(std::string);
+    pthread_mutex_unlock(&_lock);
+    return rst;
+}
+
+std::string Metrics::endpoint_name(RequestMethod method, const std::string& uri) {
+    size_t end = uri.find('?');
+    if (end == std::string::npos) end = uri.size();
+    // both the API and the upload urls go through /drive/v2/
+    size_t pos = uri.find("/drive/v2/");
+    if (pos == std::string::npos || pos >= end) {
+        return "other";
+    }
+    bool upload = pos >= 7 && uri.compare(pos - 7, 7, "/upload") == 0;
+    pos += 10;
+
+    std::vector<std::string> segments;
+    while (pos < end) {
+        size_t slash = uri.find('/', pos);
+        if (slash == std::string::npos || slash > end) slash = end;
+        segments.push_back(uri.substr(pos, slash - pos));
+        pos = slash + 1;
+    }
+    if (segments.size() == 0) {
+        return "other";
+    }
+    if (upload) {
+        return segments[0] + ".upload";
+    }
+    if (segments.size() == 2 && segments[0] == "files" && segments[1] == "trash") {
+        return "files.emptyTrash";
+    }
+    // collection/id/collection/id..., or an action after an id
+    size_t last = segments.size() - 1;
+    if (last >= 2 && last % 2 == 0) {
+        for (int i = 0; ACTIONS[i] != NULL; i ++) {
+            if (segments[last] == ACTIONS[i]) {
+                return segments[last - 2] + "." + ACTIONS[i];
+            }
+        }
+    }
+    // about is a single resource, reading it is a get
+    bool with_id = last % 2 == 1 || segments[last] == "about";
+    const std::string& collection = segments[last % 2 == 1 ? last - 1 : last];
+    const char* verb = "other";
+    switch (method) {
+        case RM_GET: verb = with_id ? "get" : "list"; break;
+        case RM_POST: verb = with_id ? "post" : "insert"; break;
+        case RM_PUT: verb = "update"; break;
+        case RM_PATCH: verb = "patch"; break;
+        case RM_DELETE: verb = "delete"; break;
+    }
+    return collection + "." + verb;
+}
+
+}
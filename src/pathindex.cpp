@@ -0,0 +1,198 @@
+#include "gdrive/pathindex.hpp"
+#include "gdrive/drive.hpp"
+
+namespace GDRIVE {
+
+PathIndex::PathIndex() {
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("PathIndex", L_DEBUG)
+#endif
+}
+
+void PathIndex::add(GFile& file) {
+    std::string id = file.get_id();
+    if (id == "") {
+        return;
+    }
+    // the file replaces whatever an earlier listing said about it, a
+    // renamed, moved or trashed file must not resolve under its old entry
+    remove(id);
+    std::string title = file.get_title();
+    if (title == "" || file.get_labels().trashed) {
+        return;
+    }
+    std::vector<GParent> parents = file.get_parents();
+    for (int i = 0; i < parents.size(); i ++) {
+        if (parents[i].get_isRoot()) {
+            add_child(ROOT_FOLDER_ALIAS, title, id);
+        } else {
+            add_child(parents[i].get_id(), title, id);
+        }
+    }
+}
+
+void PathIndex::add(std::vector<GFile>& files) {
+    for (int i = 0; i < files.size(); i ++) {
+        add(files[i]);
+    }
+}
+
+void PathIndex::add_child(std::string parent_id, std::string title, std::string id) {
+    if (_children[parent_id][title].insert(id).second) {
+        _entries[id].push_back(EntryKey(parent_id, title));
+    }
+}
+
+void PathIndex::remove(std::string id) {
+    std::map<std::string, std::vector<EntryKey> >::iterator iter = _entries.find(id);
+    if (iter == _entries.end()) {
+        return;
+    }
+    std::vector<EntryKey>& keys = iter->second;
+    for (int i = 0; i < keys.size(); i ++) {
+        TitleMap& titles = _children[keys[i].first];
+        TitleMap::iterator t = titles.find(keys[i].second);
+        if (t != titles.end()) {
+            t->second.erase(id);
+            if (t->second.size() == 0) {
+                titles.erase(t);
+            }
+        }
+        if (titles.size() == 0) {
+            _children.erase(keys[i].first);
+        }
+    }
+    _entries.erase(iter);
+}
+
+void PathIndex::apply(GChange& change) {
+    // A change may carry a narrowed file resource, so drop whatever we knew
+    // and only re-add when the change still describes a complete entry.
+    remove(change.get_fileId());
+    if (change.get_deleted()) {
+        return;
+    }
+    GFile file = change.get_file();
+    add(file);
+}
+
+void PathIndex::apply(std::vector<GChange>& changes) {
+    for (int i = 0; i < changes.size(); i ++) {
+        apply(changes[i]);
+    }
+}
+
+bool PathIndex::lookup(std::string parent_id, std::string title, std::string& id) {
+    std::map<std::string, TitleMap>::iterator iter = _children.find(parent_id);
+    if (iter == _children.end()) {
+        return false;
+    }
+    TitleMap::iterator t = iter->second.find(title);
+    if (t == iter->second.end() || t->second.size() == 0) {
+        return false;
+    }
+    id = *(t->second.begin());
+    return true;
+}
+
+std::vector<std::string> PathIndex::lookup_all(std::string parent_id, std::string title) {
+    std::vector<std::string> ids;
+    std::map<std::string, TitleMap>::iterator iter = _children.find(parent_id);
+    if (iter != _children.end()) {
+        TitleMap::iterator t = iter->second.find(title);
+        if (t != iter->second.end()) {
+            ids.insert(ids.end(), t->second.begin(), t->second.end());
+        }
+    }
+    return ids;
+}
+
+bool PathIndex::resolve(std::string path, std::string& id) {
+    std::vector<std::string> components = split_path(path);
+    std::string cur = ROOT_FOLDER_ALIAS;
+    for (int i = 0; i < components.size(); i ++) {
+        if (!lookup(cur, components[i], cur)) {
+            return false;
+        }
+    }
+    id = cur;
+    return true;
+}
+
+void PathIndex::clear() {
+    _children.clear();
+    _entries.clear();
+}
+
+std::vector<std::string> PathIndex::split_path(std::string path) {
+    std::vector<std::string> components;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        if (end > start) {
+            components.push_back(path.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return components;
+}
+
+PathResolver::PathResolver(Credential* cred)
+    :_cred(cred)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("PathResolver", L_DEBUG)
+#endif
+}
+
+std::string PathResolver::resolve(std::string path) {
+    std::vector<std::string> components = PathIndex::split_path(path);
+    std::string cur = ROOT_FOLDER_ALIAS;
+    for (int i = 0; i < components.size(); i ++) {
+        if (_index.lookup(cur, components[i], cur)) {
+            continue;
+        }
+        if (!_fetch(cur, components[i]) || !_index.lookup(cur, components[i], cur)) {
+            CLOG_DEBUG("Can't resolve %s under %s\n", components[i].c_str(), cur.c_str());
+            return "";
+        }
+    }
+    return cur;
+}
+
+bool PathResolver::_fetch(std::string parent_id, std::string title) {
+    std::string escaped;
+    for (int i = 0; i < title.size(); i ++) {
+        if (title[i] == '\'' || title[i] == '\\') {
+            escaped += '\\';
+        }
+        escaped += title[i];
+    }
+    std::string q = "title = '" + escaped + "' and trashed = false";
+
+    Drive service(_cred);
+    ChildrenListRequest list = service.children().List(parent_id);
+    bool found = false;
+    while (true) {
+        list.set_q(q);
+        GChildrenList childrenlist = list.execute();
+        list.clear();
+        std::vector<GChildren> items = childrenlist.get_items();
+        for (int i = 0; i < items.size(); i ++) {
+            _index.add_child(parent_id, title, items[i].get_id());
+            found = true;
+        }
+        std::string pageToken = childrenlist.get_nextPageToken();
+        if (pageToken == "") {
+            break;
+        } else {
+            list.set_pageToken(pageToken);
+        }
+    }
+    return found;
+}
+
+}
@@ -1,72 +1,223 @@
 #include "gdrive/request.hpp"
+#include "gdrive/metrics.hpp"
+#include "gdrive/log.hpp"
 #include "gdrive/util.hpp"
 #include "gdrive/config.hpp"
 #include "gdrive/error.hpp"
 #include <curl/curl.h>
 
-#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 using namespace COMMON;
 namespace GDRIVE {
 
+size_t FlatStringMap::_index(const char* key, size_t length) const {
+    size_t i = 0;
+    for (; i < _size; i ++) {
+        const std::string& entry = _entries[i].first;
+        if (entry.size() == length && memcmp(entry.data(), key, length) == 0) {
+            break;
+        }
+    }
+    return i;
+}
+
+std::string& FlatStringMap::_lookup(const char* key, size_t length) {
+    size_t i = _index(key, length);
+    if (i < _size) {
+        return _entries[i].second;
+    }
+    if (_size == _entries.size()) {
+        _entries.push_back(value_type());
+    }
+    value_type& entry = _entries[_size ++];
+    entry.first.assign(key, length);
+    entry.second.clear();
+    return entry.second;
+}
+
+void FlatStringMap::erase(const std::string& key) {
+    size_t i = _index(key.data(), key.size());
+    if (i == _size) {
+        return;
+    }
+    // move the entry past the live ones so its storage stays around
+    for (; i + 1 < _size; i ++) {
+        _entries[i].swap(_entries[i + 1]);
+    }
+    _size --;
+}
+
+void FlatStringMap::insert(const_iterator first, const_iterator last) {
+    // like std::map::insert, keys already set keep their value
+    for (; first != last; first ++) {
+        if (_index(first->first.data(), first->first.size()) == _size) {
+            _lookup(first->first.data(), first->first.size()) = first->second;
+        }
+    }
+}
+
+HttpResponse::HttpResponse(const HttpResponse& other)
+    :_content(other._content), _header(other._header), _status(other._status),
+    _header_index(other._header_index), _sink(NULL), _pool(other._pool),
+    _expected_length(other._expected_length), _block_start(other._block_start),
+    _header_indexed(other._header_indexed), _handle(NULL), _timing(other._timing)
+{
+}
+
+HttpResponse& HttpResponse::operator=(const HttpResponse& other) {
+    if (this == &other) {
+        return *this;
+    }
+    _content = other._content;
+    _header = other._header;
+    _status = other._status;
+    _header_index = other._header_index;
+    _expected_length = other._expected_length;
+    _block_start = other._block_start;
+    _header_indexed = other._header_indexed;
+    _timing = other._timing;
+    // curl's headers belong to another transfer now
+    _handle = NULL;
+    return *this;
+}
+
 size_t HttpResponse::curl_write_callback(void* content, size_t size, size_t nmemb, void* userp) {
-    std::string* self = (std::string*)userp;
-    std::string curr_content((char*)content, size * nmemb);
-    *self += curr_content;
+    HttpResponse* self = (HttpResponse*)userp;
+    if (self->_content.size() == 0 && self->_pool != NULL) {
+        // take the whole body's worth of room up front when it is known
+        size_t hint = self->_expected_length > size * nmemb ? self->_expected_length : size * nmemb;
+        self->_pool->acquire(self->_content, hint > RESPONSE_INITIAL_BUFFER ? hint : RESPONSE_INITIAL_BUFFER);
+    }
+    self->_content.append((char*)content, size * nmemb);
+    if (self->_sink != NULL) {
+        self->_sink->feed(self->_content);
+    }
     return size * nmemb;
 }
 
-std::string HttpResponse::get_header(std::string field) {
-    if (_header_map.size() == 0) {
-        _parse_header();
+size_t HttpResponse::curl_header_callback(void* content, size_t size, size_t nmemb, void* userp) {
+    HttpResponse* self = (HttpResponse*)userp;
+    const char* line = (const char*)content;
+    size_t length = size * nmemb;
+    // every response of a redirect chain starts with its status line,
+    // only the headers of the last one are looked up
+    if (length >= 5 && strncmp(line, "HTTP/", 5) == 0) {
+        self->_block_start = self->_header.size();
+        self->_expected_length = 0;
+    } else if (length > 15 && strncasecmp(line, "Content-Length:", 15) == 0) {
+        self->_expected_length = strtoul(line + 15, NULL, 10);
     }
-    if (_header_map.find(field) != _header_map.end()) {
-        return _header_map[field];
+    self->_header.append(line, length);
+    self->_header_indexed = false;
+    return length;
+}
+
+std::string HttpResponse::get_header(const std::string& field) {
+#if LIBCURL_VERSION_NUM >= 0x075300
+    // curl still holds the headers of the last transfer after clear()
+    if (_handle != NULL && !_header.empty()) {
+        curl_header* h = NULL;
+        CURLHcode code = curl_easy_header(_handle, field.c_str(), 0, CURLH_HEADER, -1, &h);
+        if (code == CURLHE_OK) {
+            return h->value;
+        }
+        // curl keeps no headers for file:// and may be built without the
+        // api, the received text still has them
+    }
+#endif
+    const char* value;
+    size_t length;
+    if (find_header(field.c_str(), value, length)) {
+        return std::string(value, length);
     }
     return "";
 }
 
-void HttpResponse::_parse_header() {
-    std::stringstream ssin(_header);
+bool HttpResponse::find_header(const char* field, const char*& value, size_t& length) {
+    if (!_header_indexed) {
+        _parse_header();
+    }
+    size_t field_length = strlen(field);
+    const char* base = _header.data();
+    for (int i = 0; i < _header_index.size(); i ++) {
+        const HeaderSpan& span = _header_index[i];
+        if (span.name_length == field_length && strncasecmp(base + span.name, field, field_length) == 0) {
+            value = base + span.value;
+            length = span.value_length;
+            return true;
+        }
+    }
+    return false;
+}
 
-    std::string line;
-    while(std::getline(ssin, line)) {
-        if (VarString::starts_with(line, "HTTP")) {
-            CLOG_DEBUG("First line in header %s\n", line.c_str());
-            continue;
-        } else if (line == "" or line == "\n") {
-            continue;
-        } else {
-            size_t pos = line.find(":");
-            if(pos != std::string::npos) {
-                std::string field = VarString::strip(line.substr(0, pos));
-                std::string content = VarString::strip(line.substr(pos + 1));
-                _header_map[field] = content;
-                CLOG_DEBUG("Get[%s|%s] from header\n", field.c_str(), content.c_str());
-            } else {
-                CLOG_DEBUG("Wrong line:%s\n", line.c_str());
-                continue;
+void HttpResponse::_parse_header() {
+    _header_index.clear();
+    const char* base = _header.data();
+    size_t end = _header.size();
+    size_t pos = _block_start;
+    while (pos < end) {
+        const char* eol = (const char*)memchr(base + pos, '\n', end - pos);
+        size_t line_end = eol == NULL ? end : eol - base;
+        size_t next = eol == NULL ? end : line_end + 1;
+        if (line_end > pos && base[line_end - 1] == '\r') {
+            line_end --;
+        }
+        const char* colon = (const char*)memchr(base + pos, ':', line_end - pos);
+        // the status line and the blank line ending the block have none
+        if (colon != NULL && !(line_end - pos >= 5 && strncmp(base + pos, "HTTP/", 5) == 0)) {
+            HeaderSpan span;
+            size_t name_end = colon - base;
+            while (name_end > pos && (base[name_end - 1] == ' ' || base[name_end - 1] == '\t')) {
+                name_end --;
+            }
+            size_t value = colon - base + 1;
+            while (value < line_end && (base[value] == ' ' || base[value] == '\t')) {
+                value ++;
+            }
+            size_t value_end = line_end;
+            while (value_end > value && (base[value_end - 1] == ' ' || base[value_end - 1] == '\t')) {
+                value_end --;
             }
+            span.name = pos;
+            span.name_length = name_end - pos;
+            span.value = value;
+            span.value_length = value_end - value;
+            _header_index.push_back(span);
         }
+        pos = next;
     }
+    _header_indexed = true;
 }
 
 HttpRequest::HttpRequest(std::string uri, RequestMethod method)
-    :_uri(uri), _method(method) 
+    :_uri(uri), _method(method), _url_stale(true), _encoded_size(0) 
 {
     _init_curl_handle();    
     _read_hook = NULL;
     _read_context = NULL;
+    _pool = &BufferPool::shared();
+    _header_list = NULL;
+    _metrics = &Metrics::shared();
+    _endpoint_id = -1;
+    _request_id = 0;
 #ifdef GDIRVE_DEBUG
     CLASS_INIT_LOGGER("HttpRequest", L_DEBUG);
 #endif
 }
 
 HttpRequest::HttpRequest(std::string uri, RequestMethod method, RequestHeader& header, std::string body)
-    :_uri(uri), _method(method), _body(body)
+    :_uri(uri), _method(method), _body(body), _url_stale(true), _encoded_size(0)
 {
     _init_curl_handle();
     _read_hook = NULL;
     _read_context = NULL;
+    _pool = &BufferPool::shared();
+    _header_list = NULL;
+    _metrics = &Metrics::shared();
+    _endpoint_id = -1;
+    _request_id = 0;
     _header.insert(header.begin(), header.end());
 #ifdef GDRIVE_DEBUG
     CLASS_INIT_LOGGER("HttpRequest", L_DEBUG);
@@ -75,10 +226,34 @@ HttpRequest::HttpRequest(std::string uri, RequestMethod method, RequestHeader& h
 
 HttpRequest::~HttpRequest() {
     curl_easy_cleanup(_handle);
+    if (_header_list != NULL) {
+        curl_slist_free_all(_header_list);
+    }
+    if (_pool != NULL) {
+        _pool->release(_body);
+    }
+}
+
+void HttpRequest::set_buffer_pool(BufferPool* pool) {
+    _pool = pool;
+    _resp.set_buffer_pool(pool);
+}
+
+void HttpRequest::set_metrics(Metrics* metrics) {
+    _metrics = metrics;
+    _endpoint_id = -1;
+}
+
+void HttpRequest::set_endpoint(const std::string& endpoint) {
+    _endpoint = endpoint;
+    _endpoint_id = -1;
 }
 
 void HttpRequest::set_uri(std::string uri) {
     _uri = uri;
+    _endpoint.clear();
+    _endpoint_id = -1;
+    _url_stale = true;
     curl_easy_setopt(_handle, CURLOPT_URL, _uri.c_str());
 }
 
@@ -86,26 +261,28 @@ void HttpRequest::_init_curl_handle() {
     //curl_global_init(CURL_GLOBAL_ALL);
     _handle = curl_easy_init();
     curl_easy_setopt(_handle, CURLOPT_URL, _uri.c_str());
-    curl_easy_setopt(_handle, CURLOPT_HEADERDATA, (void*)&_resp._header);
-    curl_easy_setopt(_handle, CURLOPT_WRITEDATA, (void*)&_resp._content);
+    _resp._handle = _handle;
+    curl_easy_setopt(_handle, CURLOPT_HEADERDATA, (void*)&_resp);
+    curl_easy_setopt(_handle, CURLOPT_HEADERFUNCTION, HttpResponse::curl_header_callback);
+    curl_easy_setopt(_handle, CURLOPT_WRITEDATA, (void*)&_resp);
     curl_easy_setopt(_handle, CURLOPT_WRITEFUNCTION, HttpResponse::curl_write_callback);
     _header.clear();
     _query.clear();
 }
 
-void HttpRequest::add_header(RequestHeader& header) {
+void HttpRequest::add_header(const RequestHeader& header) {
     _header.insert(header.begin(), header.end());
 }
 
-void HttpRequest::add_header(std::string key, std::string value) {
+void HttpRequest::add_header(const std::string& key, const std::string& value) {
     _header[key] = value;
 }
 
-void HttpRequest::add_query(RequestQuery& query) {
+void HttpRequest::add_query(const RequestQuery& query) {
     _query.insert(query.begin(), query.end());
 }
 
-void HttpRequest::add_query(std::string key, std::string value) {
+void HttpRequest::add_query(const std::string& key, const std::string& value) {
     _query[key] = value;
 }
 
@@ -114,26 +291,97 @@ void HttpRequest::clear() {
     _query.clear();
     _resp.clear();
     _header.clear();
-    _body = "";
+    _body.clear();
 }
 
-curl_slist* HttpRequest::_build_header() {
-    curl_slist* list = NULL;
-    VarString vs;
-    for(RequestHeader::iterator iter = _header.begin(); iter != _header.end(); iter ++) {
-        list = curl_slist_append(list, vs.append(iter->first).append(':').append(iter->second).toString().c_str());
-        vs.clear();
+void HttpRequest::_build_header() {
+    // compare against the text the current list was built from, most
+    // requests send the same headers as last time
+    size_t start = _header_lines.size();
+    for (RequestHeader::iterator iter = _header.begin(); iter != _header.end(); iter ++) {
+        _header_lines.append(iter->first).append(1, ':').append(iter->second).append(1, '\n');
+    }
+    if (_header_list != NULL && _header_lines.compare(0, start, _header_lines, start, std::string::npos) == 0) {
+        _header_lines.erase(start);
+        return;
+    }
+    _header_lines.erase(0, start);
+    if (_header_list != NULL) {
+        curl_slist_free_all(_header_list);
+        _header_list = NULL;
+    }
+    for (RequestHeader::iterator iter = _header.begin(); iter != _header.end(); iter ++) {
+        _line.assign(iter->first).append(1, ':').append(iter->second);
+        _header_list = curl_slist_append(_header_list, _line.c_str());
     }
-    return list;
 }
 
+bool HttpRequest::_build_url() {
+    // only entries whose key or value changed since the last request are
+    // encoded again, false when _url already holds the same text
+    bool changed = _url_stale || _query.size() != _encoded_size;
+    size_t i = 0;
+    for (RequestQuery::iterator iter = _query.begin(); iter != _query.end(); iter ++, i ++) {
+        if (i == _encoded_query.size()) {
+            _encoded_query.push_back(EncodedQuery());
+        }
+        EncodedQuery& entry = _encoded_query[i];
+        if (entry.key == iter->first && entry.value == iter->second) {
+            continue;
+        }
+        entry.key.assign(iter->first);
+        entry.value.assign(iter->second);
+        entry.text.assign(iter->first).append(1, '=');
+        URLHelper::encode(iter->second.data(), iter->second.size(), entry.text);
+        changed = true;
+    }
+    _encoded_size = i;
+    if (!changed) {
+        return false;
+    }
+    _url.assign(_uri);
+    for (i = 0; i < _encoded_size; i ++) {
+        _url.append(1, i == 0 ? '?' : '&').append(_encoded_query[i].text);
+    }
+    _url_stale = false;
+    return true;
+}
+
+void HttpRequest::_record_timing() {
+    TransferTiming& timing = _resp._timing;
+#if LIBCURL_VERSION_NUM >= 0x073d00
+    curl_off_t value;
+    if (curl_easy_getinfo(_handle, CURLINFO_NAMELOOKUP_TIME_T, &value) == CURLE_OK) timing.namelookup = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_CONNECT_TIME_T, &value) == CURLE_OK) timing.connect = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_APPCONNECT_TIME_T, &value) == CURLE_OK) timing.appconnect = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_PRETRANSFER_TIME_T, &value) == CURLE_OK) timing.pretransfer = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_STARTTRANSFER_TIME_T, &value) == CURLE_OK) timing.starttransfer = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_TOTAL_TIME_T, &value) == CURLE_OK) timing.total = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_SIZE_UPLOAD_T, &value) == CURLE_OK) timing.bytes_up = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_SIZE_DOWNLOAD_T, &value) == CURLE_OK) timing.bytes_down = value;
+#else
+    // older libcurl only reports seconds as doubles
+    double value;
+    if (curl_easy_getinfo(_handle, CURLINFO_NAMELOOKUP_TIME, &value) == CURLE_OK) timing.namelookup = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_CONNECT_TIME, &value) == CURLE_OK) timing.connect = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_APPCONNECT_TIME, &value) == CURLE_OK) timing.appconnect = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_PRETRANSFER_TIME, &value) == CURLE_OK) timing.pretransfer = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_STARTTRANSFER_TIME, &value) == CURLE_OK) timing.starttransfer = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_TOTAL_TIME, &value) == CURLE_OK) timing.total = value * 1e6;
+    if (curl_easy_getinfo(_handle, CURLINFO_SIZE_UPLOAD, &value) == CURLE_OK) timing.bytes_up = value;
+    if (curl_easy_getinfo(_handle, CURLINFO_SIZE_DOWNLOAD, &value) == CURLE_OK) timing.bytes_down = value;
+#endif
+}
+
+static volatile unsigned long next_request_id = 0;
+
 HttpResponse& HttpRequest::request() {
-    VarString vs;
     MemoryString ms(_body.c_str(), _body.size());
+    _request_id = __sync_add_and_fetch(&next_request_id, 1);
+    _resp.clear();
     // if there is query paremeter, append to url
-    if (_query.size() != 0) {
-        vs.append(_uri).append('?').append(URLHelper::encode(_query));
-        curl_easy_setopt(_handle, CURLOPT_URL, vs.toString().c_str());
+    if (_build_url()) {
+        curl_easy_setopt(_handle, CURLOPT_URL, _url.c_str());
     }
     
     if (_method == RM_GET) {
@@ -160,7 +408,7 @@ HttpResponse& HttpRequest::request() {
                 curl_easy_setopt(_handle, CURLOPT_READFUNCTION, _read_hook);
                 curl_easy_setopt(_handle, CURLOPT_READDATA, _read_context);
             } else {
-                CLOG_DEBUG("==>Send data %s\n", _body.c_str());
+                GLOG_DEBUG("==>Send data %s\n", _body.c_str());
                 curl_easy_setopt(_handle, CURLOPT_POSTFIELDS, _body.c_str());
             }
             if (_method == RM_POST) {
@@ -178,19 +426,19 @@ HttpResponse& HttpRequest::request() {
     curl_easy_setopt(_handle, CURLOPT_VERBOSE, 1);
 #endif
     curl_easy_setopt(_handle, CURLOPT_USE_SSL, CURLUSESSL_ALL);
-    curl_slist* header_list = NULL;
     if (_header.size() > 0) {
-        header_list = _build_header();
-        curl_easy_setopt(_handle, CURLOPT_HTTPHEADER, header_list);
+        _build_header();
+    } else if (_header_list != NULL) {
+        curl_slist_free_all(_header_list);
+        _header_list = NULL;
+        _header_lines.clear();
     }
+    curl_easy_setopt(_handle, CURLOPT_HTTPHEADER, _header_list);
     CURLcode res = curl_easy_perform(_handle);
-    
-    if (header_list != NULL) {
-        curl_slist_free_all(header_list);
-    }
+    _record_timing();
 
     if (res != CURLE_OK) {
-        throw CurlException(res, curl_easy_strerror(res)); 
+        throw CurlException(res, curl_easy_strerror(res), _resp.timing());
     }
 
     int status;
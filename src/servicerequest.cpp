@@ -1,4 +1,5 @@
 #include "gdrive/servicerequest.hpp"
+#include "gdrive/log.hpp"
 #include "jconer/json.hpp"
 
 #include <string.h>
@@ -9,21 +10,21 @@ using namespace JCONER;
 
 namespace GDRIVE {
 
-GoogleJsonResponseException make_json_exception(std::string content) {
+GoogleJsonResponseException make_json_exception(const HttpResponse& resp) {
     GError gerror;
-    PError perror;
-    JObject* obj = (JObject*)loads(content, perror);
-    if (obj != NULL) {
-        gerror.from_json(obj);
-        delete obj;
+    JsonReader reader(resp.content());
+    try {
+        gerror.from_json(reader);
+    } catch (JsonParseException& e) {
+        // not a JSON error body, keep whatever was decoded
     }
-    return GoogleJsonResponseException(gerror);
+    return GoogleJsonResponseException(gerror, resp.timing());
 }
 
 void DeleteRequest::execute() {
     CredentialHttpRequest::request();
     if (_resp.status() != 204) {
-        GoogleJsonResponseException exc = make_json_exception(_resp.content());
+        GoogleJsonResponseException exc = make_json_exception(_resp);
         throw exc;
     }   
 }
@@ -36,6 +37,26 @@ void FileListRequest::set_corpus(std::string corpus) {
     }
 }
 
+void FileListRequest::set_projection(const GFileProjection& projection) {
+    clear_fields();
+    if (projection.mask() == 0) {
+        return;
+    }
+    _projection_fields = projection.to_list_fields();
+    _query["fields"] = _projection_fields;
+    _projection = projection.mask();
+}
+
+void FileGetRequest::set_projection(const GFileProjection& projection) {
+    clear_fields();
+    if (projection.mask() == 0) {
+        return;
+    }
+    _projection_fields = projection.to_fields();
+    _query["fields"] = _projection_fields;
+    _projection = projection.mask();
+}
+
 void FileListRequest::set_maxResults(int max_results) {
     if (max_results >= 0) {
         _query["maxResults"] = VarString::itos(max_results);
@@ -56,7 +77,7 @@ int FileUploadRequest::_resume() {
         std::string range = _resp.get_header("Range");
         cur_pos = atoi(VarString::split(range, "-")[1].c_str());
     } else {
-        GoogleJsonResponseException exc = make_json_exception(_resp.content());
+        GoogleJsonResponseException exc = make_json_exception(_resp);
         throw exc;
     }
     _read_hook = FileContent::resumable_read;
@@ -66,8 +87,9 @@ int FileUploadRequest::_resume() {
 
 GFile FileUploadRequest::execute() {
     int upload_type = -1;
-    std::set<std::string> fields = _resource->get_modified_fields();
-    if (fields.size() == 0 ) {
+    int retries = 0;
+    FieldMask fields = _resource->get_modified_mask();
+    if (fields == 0) {
         if ( _resumable == true || _content->get_length() >= RESUMABLE_THRESHOLD) {
             upload_type = 2;
             _query["uploadType"] = "resumable";
@@ -92,7 +114,7 @@ GFile FileUploadRequest::execute() {
         _header["Content-Length"] = VarString::itos(_content->get_length());
         request();
         if ((_type == UT_CREATE && _resp.status() != 200) || (_type == UT_UPDATE && _resp.status() != 201)) {
-            GoogleJsonResponseException exc = make_json_exception(_resp.content());
+            GoogleJsonResponseException exc = make_json_exception(_resp);
             throw exc;
         }
     } else if (upload_type == 1) { // multipart upload
@@ -110,7 +132,7 @@ GFile FileUploadRequest::execute() {
         _header["Content-Length"] = VarString::itos(_body.size());
         request();
         if ((_type == UT_CREATE && _resp.status() != 200) || (_type == UT_UPDATE && _resp.status() != 201)) {
-            GoogleJsonResponseException exc = make_json_exception(_resp.content());
+            GoogleJsonResponseException exc = make_json_exception(_resp);
             throw exc;
         }
 
@@ -118,14 +140,14 @@ GFile FileUploadRequest::execute() {
         // Step 1 - Start a resumable session
         _header["X-Upload-Content-Type"] = _content->mimetype();
         _header["X-Upload-Content-Length"] = VarString::itos(_content->get_length());
-        if (fields.size() != 0) {
+        if (fields != 0) {
             _json_encode_body();
         }
         request();
         
         // Step 2 - Save the resumable session URI
         if (_resp.status() != 200)  {
-            GoogleJsonResponseException exc = make_json_exception(_resp.content());
+            GoogleJsonResponseException exc = make_json_exception(_resp);
             throw exc;
         }
 
@@ -133,6 +155,7 @@ GFile FileUploadRequest::execute() {
 
         // Prepare for step 3
         set_uri(location);
+        set_endpoint("files.upload_chunk");
         _method = RM_PUT;
 
         // Step 3 - Upload the file
@@ -140,6 +163,7 @@ GFile FileUploadRequest::execute() {
         if (_content->get_length() > RESUMABLE_CHUNK_SIZE) { // Uploading the file in chunks
             int cur_pos = 0;
             while (true) {
+                TraceSpan span("upload_chunk", "upload");
                 clear();
                 int cur_length = file_length - cur_pos > RESUMABLE_CHUNK_SIZE ? RESUMABLE_CHUNK_SIZE : file_length - cur_pos;
                 _header["Content-Length"] = VarString::itos(cur_length);
@@ -149,11 +173,11 @@ GFile FileUploadRequest::execute() {
                 _content->set_resumable_length(cur_length);
                 _read_hook = FileContent::resumable_read;
                 _read_context = (void*)_content;
-                CLOG_DEBUG("Sending out from %d - %d/%d\n", cur_pos, cur_pos + cur_length - 1, file_length);
+                GLOG_DEBUG("Sending out from %d - %d/%d\n", cur_pos, cur_pos + cur_length - 1, file_length);
                 request();
                 
                 if (_resp.status() == 308) {
-                    CLOG_DEBUG("Resumabled\n");
+                    GLOG_REQUEST(GDRIVE_LOG_DEBUG, _request_id, _endpoint.c_str(), _resp.status(), "Resumabled\n");
                     std::string range = _resp.get_header("Range");
                     cur_pos = atoi(VarString::split(range, "-")[1].c_str()) + 1;
                 } else if (_resp.status() == 200 || _resp.status() == 201) {
@@ -161,14 +185,16 @@ GFile FileUploadRequest::execute() {
                 } else if (_resp.status() >= 500) {
                     // resume an interrupted upload
                     cur_pos = _resume();
+                    retries ++;
                 } else {
-                    GoogleJsonResponseException exc = make_json_exception(_resp.content());
+                    GoogleJsonResponseException exc = make_json_exception(_resp);
                     throw exc;
                 }
             }
         } else { // Uploading the file completely in one request
             int cur_pos;
             while(true) {
+                TraceSpan span("upload_chunk", "upload");
                 clear();
                 _header["Content-Length"] = VarString::itos(_content->get_length());
                 _header["Content-Type"] = _content->mimetype();
@@ -184,14 +210,16 @@ GFile FileUploadRequest::execute() {
                 } else if (_resp.status() >= 500 ){
                     // resume an interrupted upload
                     cur_pos = _resume();
+                    retries ++;
                 } else {
-                    GoogleJsonResponseException exc = make_json_exception(_resp.content());
+                    GoogleJsonResponseException exc = make_json_exception(_resp);
                     throw exc;
                 }
             }
         }
     }
-    GFile _1 = *_resource;
+    _resp.set_retries(_resp.timing().retries + retries);
+    GFile _1;
     this->get_resource(_1);
     return _1;
 }
@@ -0,0 +1,223 @@
+#include "gdrive/tracer.hpp"
+
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace GDRIVE {
+
+Tracer::Tracer()
+    :_enabled(false), _stop(false), _file(NULL), _first(true)
+{
+#ifdef GDRIVE_DEBUG
+    CLASS_INIT_LOGGER("Tracer", L_DEBUG)
+#endif
+    pthread_key_create(&_key, NULL);
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_wake, NULL);
+}
+
+Tracer::~Tracer() {
+    stop();
+    for (int i = 0; i < _buffers.size(); i ++) {
+        pthread_mutex_destroy(&_buffers[i]->lock);
+        delete _buffers[i];
+    }
+    pthread_key_delete(_key);
+    pthread_cond_destroy(&_wake);
+    pthread_mutex_destroy(&_lock);
+}
+
+Tracer& Tracer::shared() {
+    // never destroyed, threads may still be tracing at exit
+    static Tracer* tracer = new Tracer();
+    return *tracer;
+}
+
+long long Tracer::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool Tracer::start(const std::string& path) {
+    if (_file != NULL) {
+        CLOG_WARN("Tracer already writing\n");
+        return false;
+    }
+    _file = fopen(path.c_str(), "w");
+    if (_file == NULL) {
+        CLOG_WARN("Cannot write trace to %s\n", path.c_str());
+        return false;
+    }
+    fputs("{\"traceEvents\":[", _file);
+    _first = true;
+    _stop = false;
+    pthread_mutex_lock(&_lock);
+    // events left from an earlier run belong to no file
+    for (int i = 0; i < _buffers.size(); i ++) {
+        pthread_mutex_lock(&_buffers[i]->lock);
+        _buffers[i]->events.clear();
+        pthread_mutex_unlock(&_buffers[i]->lock);
+    }
+    pthread_mutex_unlock(&_lock);
+    pthread_create(&_flusher, NULL, _flush_loop, this);
+    _enabled = true;
+    return true;
+}
+
+void Tracer::stop() {
+    if (_file == NULL) {
+        return;
+    }
+    _enabled = false;
+    pthread_mutex_lock(&_lock);
+    _stop = true;
+    pthread_cond_signal(&_wake);
+    pthread_mutex_unlock(&_lock);
+    // the flusher writes what is left before it exits
+    pthread_join(_flusher, NULL);
+    fputs("\n]}\n", _file);
+    fclose(_file);
+    _file = NULL;
+}
+
+Tracer::Buffer* Tracer::_buffer() {
+    Buffer* buffer = (Buffer*)pthread_getspecific(_key);
+    if (buffer == NULL) {
+        buffer = new Buffer();
+        pthread_mutex_init(&buffer->lock, NULL);
+        buffer->events.reserve(1024);
+        pthread_mutex_lock(&_lock);
+        _buffers.push_back(buffer);
+        pthread_mutex_unlock(&_lock);
+        pthread_setspecific(_key, buffer);
+    }
+    return buffer;
+}
+
+void Tracer::span(const char* name, const char* category, long long begin, long long end, const char* arg) {
+    if (!_enabled) {
+        return;
+    }
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.begin = begin;
+    event.duration = end > begin ? end - begin : 0;
+    event.arg[0] = '\0';
+    if (arg != NULL) {
+        strncpy(event.arg, arg, TRACE_ARG_SIZE - 1);
+        event.arg[TRACE_ARG_SIZE - 1] = '\0';
+    }
+    Buffer* buffer = _buffer();
+    // only the flusher competes for this lock, and only to swap
+    pthread_mutex_lock(&buffer->lock);
+    buffer->events.push_back(event);
+    pthread_mutex_unlock(&buffer->lock);
+}
+
+void Tracer::transfer(const char* endpoint, long long begin, int status, const TransferTiming& timing) {
+    if (!_enabled) {
+        return;
+    }
+    char arg[TRACE_ARG_SIZE];
+    snprintf(arg, sizeof(arg), "%s %d", endpoint, status);
+    span("request", "http", begin, begin + timing.total, arg);
+    long long connected = timing.appconnect > timing.connect ? timing.appconnect : timing.connect;
+    if (timing.namelookup > 0) {
+        span("dns", "http", begin, begin + timing.namelookup);
+    }
+    if (timing.connect > timing.namelookup) {
+        span("connect", "http", begin + timing.namelookup, begin + timing.connect);
+    }
+    if (timing.appconnect > timing.connect) {
+        span("tls", "http", begin + timing.connect, begin + timing.appconnect);
+    }
+    if (timing.starttransfer > connected) {
+        span("wait", "http", begin + connected, begin + timing.starttransfer);
+    }
+    if (timing.total > timing.starttransfer && timing.starttransfer > 0) {
+        span("receive", "http", begin + timing.starttransfer, begin + timing.total);
+    }
+}
+
+static void write_json_string(FILE* file, const char* value) {
+    fputc('"', file);
+    for (const char* p = value; *p != '\0'; p ++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', file);
+            fputc(*p, file);
+        } else if ((unsigned char)*p >= 0x20) {
+            fputc(*p, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void Tracer::_flush() {
+    int pid = getpid();
+    // take the events under the lock, a thread tracing its first span
+    // waits on it only for the swaps, not for the file
+    pthread_mutex_lock(&_lock);
+    if (_writing.size() < _buffers.size()) {
+        _writing.resize(_buffers.size());
+    }
+    for (int i = 0; i < _buffers.size(); i ++) {
+        Buffer* buffer = _buffers[i];
+        pthread_mutex_lock(&buffer->lock);
+        buffer->events.swap(_writing[i]);
+        pthread_mutex_unlock(&buffer->lock);
+    }
+    pthread_mutex_unlock(&_lock);
+
+    for (int i = 0; i < _writing.size(); i ++) {
+        // threads are numbered from 1 in the order their buffers were made
+        int tid = i + 1;
+        for (int j = 0; j < _writing[i].size(); j ++) {
+            const Event& event = _writing[i][j];
+            fputs(_first ? "\n" : ",\n", _file);
+            _first = false;
+            fputs("{\"name\":", _file);
+            write_json_string(_file, event.name);
+            fputs(",\"cat\":", _file);
+            write_json_string(_file, event.category);
+            fprintf(_file, ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%d",
+                    event.begin, event.duration, pid, tid);
+            if (event.arg[0] != '\0') {
+                fputs(",\"args\":{\"detail\":", _file);
+                write_json_string(_file, event.arg);
+                fputc('}', _file);
+            }
+            fputc('}', _file);
+        }
+        _writing[i].clear();
+    }
+    fflush(_file);
+}
+
+void* Tracer::_flush_loop(void* self) {
+    Tracer* tracer = (Tracer*)self;
+    while (true) {
+        pthread_mutex_lock(&tracer->_lock);
+        if (!tracer->_stop) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            struct timespec deadline;
+            long long usec = tv.tv_usec + TRACE_FLUSH_INTERVAL_MS * 1000LL;
+            deadline.tv_sec = tv.tv_sec + usec / 1000000;
+            deadline.tv_nsec = (usec % 1000000) * 1000;
+            pthread_cond_timedwait(&tracer->_wake, &tracer->_lock, &deadline);
+        }
+        bool stop = tracer->_stop;
+        pthread_mutex_unlock(&tracer->_lock);
+        tracer->_flush();
+        if (stop) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+}
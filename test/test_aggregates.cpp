@@ -0,0 +1,71 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+GFile make_file(std::string id, std::string parent, long size, bool folder = false) {
+    std::string repr = "{\"id\": \"" + id + "\", \"title\": \"" + id + "\", "
+                     + "\"mimeType\": \"" + (folder ? FOLDER_MIMETYPE : "text/plain") + "\", "
+                     + "\"fileSize\": " + VarString::itos(size) + ", "
+                     + "\"quotaBytesUsed\": " + VarString::itos(size) + ", "
+                     + "\"parents\": [{\"id\": \"" + parent + "\", \"isRoot\": false}]}";
+    GFile file;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    file.from_json(obj);
+    delete obj;
+    return file;
+}
+
+GChange make_delete(std::string id) {
+    GChange change;
+    PError error;
+    JObject* obj = (JObject*)loads("{\"fileId\": \"" + id + "\", \"deleted\": true}", error);
+    change.from_json(obj);
+    delete obj;
+    return change;
+}
+
+int main() {
+    FolderAggregates aggregates;
+
+    // children may arrive before their folders
+    GFile f1 = make_file("f1", "b", 100);
+    GFile f2 = make_file("f2", "b", 50);
+    GFile b = make_file("b", "a", -1, true);
+    GFile a = make_file("a", "root", -1, true);
+    GFile c = make_file("c", "root", -1, true);
+    aggregates.add(f1);
+    aggregates.add(f2);
+    aggregates.add(b);
+    aggregates.add(a);
+    aggregates.add(c);
+
+    FolderTotals t = aggregates.totals("root");
+    assert(t.files == 2 && t.folders == 3 && t.bytes == 150);
+    t = aggregates.totals("a");
+    assert(t.files == 2 && t.folders == 1 && t.bytes == 150 && t.quota_bytes == 150);
+
+    // move b with its subtree from a to c
+    GFile moved = make_file("b", "c", -1, true);
+    aggregates.add(moved);
+    assert(aggregates.totals("a").bytes == 0);
+    assert(aggregates.totals("c").bytes == 150);
+    assert(aggregates.totals("root").bytes == 150);
+
+    // resize and delete
+    GFile grown = make_file("f1", "b", 300);
+    aggregates.add(grown);
+    assert(aggregates.totals("c").bytes == 350);
+    GChange change = make_delete("f2");
+    aggregates.apply(change);
+    t = aggregates.totals("root");
+    assert(t.files == 1 && t.bytes == 300);
+
+    std::cout << "FolderAggregates OK" << std::endl;
+}
@@ -0,0 +1,66 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace GDRIVE;
+
+int main() {
+    BufferPool pool(64 << 10);
+
+    // small buffers are not kept
+    std::string small = "abc";
+    pool.release(small);
+    assert(pool.size() == 0);
+
+    // released storage comes back to the next acquire that fits
+    std::string buffer;
+    pool.acquire(buffer, 10000);
+    assert(buffer.capacity() >= 10000 && buffer.size() == 0);
+    buffer = "page";
+    const char* storage = buffer.data();
+    pool.release(buffer);
+    assert(pool.size() == 1 && pool.retained() >= 10000 && buffer.capacity() < 10000);
+
+    std::string other;
+    pool.acquire(other, 20000);
+    assert(pool.size() == 1 && other.capacity() >= 20000);
+    std::string again;
+    pool.acquire(again, 5000);
+    assert(again.data() == storage && again.size() == 0 && pool.size() == 0 && pool.retained() == 0);
+
+    // nothing past the cap is retained
+    std::string large;
+    large.reserve(128 << 10);
+    pool.release(large);
+    assert(pool.size() == 0 && large.capacity() < BUFFER_POOL_MIN_BUFFER);
+
+    // responses take their body buffer from the pool and give it back
+    char path[] = "/tmp/gdrive_bufferpoolXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    std::string body(50000, 'x');
+    assert(write(fd, body.data(), body.size()) == (ssize_t)body.size());
+    close(fd);
+    {
+        HttpRequest request(std::string("file://") + path, RM_GET);
+        request.set_buffer_pool(&pool);
+        request.request();
+        assert(request.response().content() == body);
+        storage = request.response().content().data();
+    }
+    assert(pool.size() == 1);
+    {
+        HttpRequest request(std::string("file://") + path, RM_GET);
+        request.set_buffer_pool(&pool);
+        request.request();
+        assert(request.response().content() == body && request.response().content().data() == storage);
+        assert(pool.size() == 0);
+    }
+    remove(path);
+
+    std::cout << "BufferPool OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <string.h>
+
+using namespace GDRIVE;
+
+const char* FILE_JSON =
+    "{\"id\": \"f1\", \"title\": \"report.pdf\", \"mimeType\": \"application/pdf\",\n"
+    " \"iconLink\": \"http://x/pdf.png\", \"fileExtension\": \"pdf\",\n"
+    " \"md5Checksum\": \"0123456789abcdef0123456789ABCDEF\", \"fileSize\": 4096,\n"
+    " \"modifiedDate\": \"2014-03-10T10:20:30.000Z\", \"labels\": {\"starred\": true},\n"
+    " \"parents\": [{\"id\": \"p1\", \"isRoot\": false}, {\"id\": \"root\", \"isRoot\": true}],\n"
+    " \"ownerNames\": [\"alice\"], \"editable\": true,\n"
+    " \"description\": \"quarterly numbers\",\n"
+    " \"owners\": [{\"displayName\": \"alice\", \"permissionId\": \"42\"}]}";
+
+int main() {
+    StringPool pool;
+    GFile file;
+    JsonReader reader(FILE_JSON, strlen(FILE_JSON));
+    file.from_json(reader);
+
+    CompactFile compact(file, pool);
+    assert(compact.get_id() == "f1" && compact.get_title() == "report.pdf");
+    assert(compact.get_mimeType() == "application/pdf" && compact.get_fileExtension() == "pdf");
+    assert(compact.get_md5Checksum() == "0123456789abcdef0123456789abcdef");
+    assert(compact.get_fileSize() == 4096 && compact.get_quotaBytesUsed() == -1);
+    assert(compact.get_modifiedDate_ms() == 1394446830000LL && compact.get_createdDate_ms() == 0);
+    assert(compact.get_starred() && !compact.get_trashed() && compact.get_editable());
+    assert(compact.parent_count() == 2 && compact.get_parent_id(1) == "root");
+    assert(!compact.get_parent_isRoot(0) && compact.get_parent_isRoot(1));
+    assert(compact.owner_count() == 1 && compact.get_ownerName(0) == "alice");
+
+    // fields outside the inline set are read back from the side allocation
+    assert(compact.has_rare());
+    assert(compact.rare().get_description() == "quarterly numbers");
+    assert(compact.rare().get_owners()[0].permissionId == "42");
+    assert(!compact.rare().has(GF_sharingUser) && !compact.rare().has(GF_title));
+
+    // repeated values are stored once
+    size_t pooled = pool.size();
+    CompactFile copy(file, pool);
+    assert(pool.size() == pooled);
+    copy = compact;
+    assert(copy.rare().get_description() == "quarterly numbers");
+
+    // and the whole file can be rebuilt
+    GFile rebuilt = compact.to_gfile();
+    assert(rebuilt.get_title() == "report.pdf" && rebuilt.get_description() == "quarterly numbers");
+    assert(rebuilt.get_md5Checksum() == "0123456789abcdef0123456789abcdef");
+    assert(rebuilt.get_modifiedDate().tm_hour == 10 && rebuilt.get_labels().starred);
+    assert(rebuilt.get_parents().size() == 2 && rebuilt.get_parents()[1].get_isRoot());
+
+    // a projected file never leaves the inline fields
+    GFile projected;
+    JsonReader projected_reader(FILE_JSON, strlen(FILE_JSON));
+    projected.from_json(projected_reader, CompactFile::inline_fields());
+    CompactFile lean(projected, pool);
+    assert(!lean.has_rare() && lean.rare().get_description() == "");
+    assert(lean.memory_usage() * 4 < sizeof(GFile));
+
+    // a title past the inline buffer of std::string is counted, 16 to 31
+    // characters included
+    GFile titled = projected;
+    titled.set_title("quarterly report.pdf");
+    CompactFile long_title(titled, pool);
+    assert(long_title.memory_usage() >= lean.memory_usage() + strlen("quarterly report.pdf") + 1);
+    size_t pool_usage = pool.memory_usage();
+    pool.intern("application/vnd.ms-excel");
+    size_t node = sizeof(std::pair<const std::string, StringPool::Id>) + 4 * sizeof(void*);
+    assert(pool.memory_usage() >= pool_usage + node + strlen("application/vnd.ms-excel") + 1);
+
+    CompactFile empty;
+    assert(empty.get_mimeType() == "" && empty.get_fileSize() == -1);
+
+    std::cout << "sizeof(GFile) " << sizeof(GFile) << ", CompactFile " << compact.memory_usage()
+        << ", projected " << lean.memory_usage() << std::endl;
+    std::cout << "CompactFile OK" << std::endl;
+    return 0;
+}
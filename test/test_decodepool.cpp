@@ -0,0 +1,88 @@
+#include "gdrive/gdrive.hpp"
+#include "common/all.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace COMMON;
+
+std::string make_page(int count) {
+    std::string page = "{\"kind\": \"drive#fileList\", \"nextPageToken\": \"more\", \"items\": [";
+    for (int i = 0; i < count; i ++) {
+        if (i != 0) page += ",";
+        std::string n = VarString::itos(i);
+        page += "{\"id\": \"id" + n + "\", \"title\": \"file {" + n + "}\", \"fileSize\": \"" + n + "\", "
+              + "\"parents\": [{\"id\": \"root\", \"isRoot\": true}], \"labels\": {\"starred\": false}}";
+    }
+    page += "]}";
+    return page;
+}
+
+struct Order {
+    int next;
+    bool ok;
+};
+
+void check_order(GFile& file, void* context) {
+    Order* order = (Order*)context;
+    if (file.get_id() != "id" + VarString::itos(order->next)) order->ok = false;
+    order->next ++;
+}
+
+void add_range(void* context, size_t begin, size_t end) {
+    __sync_fetch_and_add((long*)context, (long)(end - begin));
+}
+
+int main() {
+    DecodePool pool(4);
+    assert(pool.concurrency() == 5);
+
+    long covered = 0;
+    for (int i = 0; i < 100; i ++) {
+        pool.run(add_range, &covered, 1000, 7);
+    }
+    assert(covered == 100000);
+
+    std::string page = make_page(1000);
+    GFileList serial;
+    decode_list<GFileList, GFile>(page, serial, NULL);
+    GFileList parallel;
+    decode_list<GFileList, GFile>(page, parallel, &pool);
+
+    std::vector<GFile> a = serial.get_items();
+    std::vector<GFile> b = parallel.get_items();
+    assert(a.size() == 1000 && b.size() == 1000);
+    for (int i = 0; i < b.size(); i ++) {
+        assert(b[i].get_id() == "id" + VarString::itos(i));
+        assert(b[i].get_title() == a[i].get_title());
+        assert(b[i].get_fileSize() == i);
+        assert(b[i].get_parents().size() == 1);
+    }
+    assert(parallel.get_nextPageToken() == "more");
+
+    // callbacks still see the page in order
+    Order order;
+    order.next = 0;
+    order.ok = true;
+    ItemStream<GFile> stream(check_order, &order);
+    stream.set_pool(&pool);
+    stream.feed(page);
+    GFileList streamed;
+    assert(stream.finish(page, streamed));
+    assert(order.ok && order.next == 1000);
+    assert(streamed.get_items().size() == 1000);
+
+    // a bad item fails the page instead of dropping it
+    std::string broken = page;
+    broken.replace(broken.find("\"fileSize\": \"500\""), 17, "\"fileSize\": [500]");
+    ItemStream<GFile> failing;
+    failing.set_pool(&pool);
+    failing.feed(broken);
+    GFileList untouched;
+    assert(!failing.finish(broken, untouched));
+    assert(untouched.get_items().size() == 0);
+
+    std::cout << "DecodePool OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+GFile make_file(std::string id, std::string title, std::string parent, bool is_root = false) {
+    std::string repr = "{\"id\": \"" + id + "\", \"title\": \"" + title + "\", "
+                     + "\"mimeType\": \"" FOLDER_MIMETYPE "\", "
+                     + "\"parents\": [{\"id\": \"" + parent + "\", \"isRoot\": " + (is_root ? "true" : "false") + "}]}";
+    GFile file;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    file.from_json(obj);
+    delete obj;
+    return file;
+}
+
+int main() {
+    std::vector<GFile> files;
+    files.push_back(make_file("a", "projects", "r0", true));
+    files.push_back(make_file("b", "2026", "a"));
+    files.push_back(make_file("c", "report.pdf", "b"));
+    files.push_back(make_file("d", "notes", "a"));
+
+    DirectoryGraph graph;
+    graph.add(files);
+    assert(graph.size() == 5);
+
+    NodeIndex root = graph.find("r0");
+    NodeIndex c = graph.find("c");
+    assert(graph.is_root(root));
+    assert(graph.path(c) == "/projects/2026/report.pdf");
+    assert(graph.path(root) == "/");
+    assert(graph.subtree(root).size() == 5);
+    assert(graph.subtree(graph.find("a")).size() == 4);
+    assert(graph.ancestors(c).size() == 3);
+
+    // a parent missing from the listing leaves no path to root
+    GFile orphan = make_file("o", "orphan.txt", "missing");
+    NodeIndex o = graph.add(orphan);
+    assert(graph.path(o) == "");
+
+    // a second parent that reaches root gives the path the first one cannot
+    std::vector<NodeIndex> both;
+    both.push_back(graph.find("missing"));
+    both.push_back(graph.find("d"));
+    graph.set_parents(o, both);
+    assert(graph.path(o) == "/projects/notes/orphan.txt");
+    graph.add(orphan);
+
+    // move 2026 under notes
+    GFile moved = make_file("b", "2026", "d");
+    graph.add(moved);
+    assert(graph.path(c) == "/projects/notes/2026/report.pdf");
+    assert(graph.children(graph.find("a")).size() == 1);
+
+    // a cycle must not hang any traversal
+    GFile loop = make_file("a", "projects", "c");
+    graph.add(loop);
+    assert(graph.path(c) == "");
+    assert(graph.subtree(graph.find("a")).size() == 4);
+    assert(graph.ancestors(c).size() == 3);
+
+    graph.remove("b");
+    assert(graph.is_removed(graph.find("b")));
+    assert(graph.children(graph.find("d")).size() == 0);
+    assert(graph.parents(c).size() == 1);
+    // nor does a removed ancestor
+    assert(graph.path(c) == "");
+
+    std::cout << "DirectoryGraph OK, " << graph.memory_usage() << " bytes" << std::endl;
+}
@@ -0,0 +1,82 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+static const char* MD5_A = "9e107d9d372bb6826bd81d3542a419d6";
+static const char* MD5_B = "E4D909C290D0FB1CA068FFADDF22CBD0";
+
+GFile make_file(std::string id, std::string md5, long size, bool trashed = false) {
+    std::string repr = "{\"id\": \"" + id + "\", \"title\": \"" + id + "\", \"mimeType\": \"application/pdf\", "
+                       "\"md5Checksum\": \"" + md5 + "\", \"fileSize\": " + VarString::itos(size) + ", "
+                       "\"labels\": {\"trashed\": " + (trashed ? "true" : "false") + "}}";
+    GFile file;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    file.from_json(obj);
+    delete obj;
+    return file;
+}
+
+GChange make_change(std::string repr) {
+    GChange change;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    change.from_json(obj);
+    delete obj;
+    return change;
+}
+
+int main() {
+    DuplicateIndex index;
+    std::vector<GFile> files;
+    files.push_back(make_file("a1", MD5_A, 100));
+    files.push_back(make_file("a2", MD5_A, 100));
+    files.push_back(make_file("a3", MD5_A, 100));
+    // same checksum, different size: not the same content
+    files.push_back(make_file("a4", MD5_A, 101));
+    files.push_back(make_file("b1", MD5_B, 1000));
+    files.push_back(make_file("b2", "e4d909c290d0fb1ca068ffaddf22cbd0", 1000));
+    // no usable checksum
+    files.push_back(make_file("x1", "", 100));
+    files.push_back(make_file("x2", "9e107d9d372bb6826bd81d3542a419", 100));
+    files.push_back(make_file("x3", "9e107d9d372bb6826bd81d3542a419zz", 100));
+    files.push_back(make_file("t1", MD5_A, 100, true));
+    index.add(files);
+    assert(index.size() == 6);
+
+    // ordered by reclaimable bytes, checksums come back in lower case
+    std::vector<DuplicateGroup> groups = index.groups();
+    assert(groups.size() == 2);
+    assert(groups[0].md5Checksum == "e4d909c290d0fb1ca068ffaddf22cbd0" && groups[0].fileSize == 1000);
+    assert(groups[0].ids.size() == 2 && groups[0].reclaimable() == 1000);
+    assert(groups[1].md5Checksum == MD5_A && groups[1].fileSize == 100);
+    assert(groups[1].ids.size() == 3 && groups[1].ids[0] == "a1" && groups[1].ids[2] == "a3");
+    assert(groups[1].reclaimable() == 200);
+    assert(index.reclaimable() == 1200);
+
+    // a file trashed later leaves its group, one without copies is dropped
+    GFile trashed = make_file("b2", MD5_B, 1000, true);
+    index.add(trashed);
+    groups = index.groups();
+    assert(groups.size() == 1 && groups[0].md5Checksum == MD5_A);
+
+    GChange change = make_change("{\"fileId\": \"a1\", \"deleted\": true}");
+    index.apply(change);
+    change = make_change("{\"fileId\": \"a4\", \"deleted\": false, \"file\": "
+                         "{\"id\": \"a4\", \"md5Checksum\": \"9e107d9d372bb6826bd81d3542a419d6\", \"fileSize\": 100}}");
+    index.apply(change);
+    groups = index.groups();
+    assert(groups.size() == 1 && groups[0].ids.size() == 3 && groups[0].ids[0] == "a2");
+    assert(index.reclaimable() == 200);
+
+    index.clear();
+    assert(index.size() == 0 && index.groups().size() == 0);
+    std::cout << "DuplicateIndex OK" << std::endl;
+}
@@ -0,0 +1,119 @@
+#include "gdrive/request.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace GDRIVE;
+
+// answers one request over plain http with a header to look up
+struct Server {
+    int fd;
+    int port;
+};
+
+static void* serve(void* arg) {
+    Server* server = (Server*)arg;
+    int client = accept(server->fd, NULL, NULL);
+    std::string request;
+    char buf[4096];
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = recv(client, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, n);
+    }
+    const char* resp = "HTTP/1.1 200 OK\r\nX-Request-Number: 1\r\nConnection: close\r\n"
+                       "Content-Length: 2\r\n\r\n{}";
+    send(client, resp, strlen(resp), 0);
+    close(client);
+    return NULL;
+}
+
+static void start(Server& server) {
+    server.fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    assert(bind(server.fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    assert(listen(server.fd, 1) == 0);
+    socklen_t length = sizeof(addr);
+    getsockname(server.fd, (struct sockaddr*)&addr, &length);
+    server.port = ntohs(addr.sin_port);
+}
+
+static void feed(HttpResponse& resp, const char* line) {
+    HttpResponse::curl_header_callback((void*)line, 1, strlen(line), (void*)&resp);
+}
+
+int main() {
+    HttpResponse resp;
+    feed(resp, "HTTP/1.1 302 Found\r\n");
+    feed(resp, "Location: https://example.com/first\r\n");
+    feed(resp, "X-Only-Redirect: yes\r\n");
+    feed(resp, "\r\n");
+    feed(resp, "HTTP/1.1 308 Resume Incomplete\r\n");
+    feed(resp, "range: bytes=0-262143\r\n");
+    feed(resp, "Location :  https://example.com/upload?id=1  \r\n");
+    feed(resp, "Content-Length: 0\r\n");
+    feed(resp, "X-Empty:\r\n");
+    feed(resp, "\r\n");
+
+    // only the last block counts and names match in any case
+    assert(resp.get_header("Range") == "bytes=0-262143");
+    assert(resp.get_header("RANGE") == "bytes=0-262143");
+    assert(resp.get_header("Location") == "https://example.com/upload?id=1");
+    assert(resp.get_header("X-Only-Redirect") == "");
+    assert(resp.get_header("X-Empty") == "");
+    assert(resp.get_header("Missing") == "");
+
+    // values point into the received header text
+    const char* value;
+    size_t length;
+    assert(resp.find_header("content-length", value, length));
+    assert(length == 1 && *value == '0');
+    assert(value >= resp.header().data() && value < resp.header().data() + resp.header().size());
+    assert(!resp.find_header("Locatio", value, length));
+
+    // headers arriving later are indexed again
+    feed(resp, "HTTP/1.1 200 OK\r\n");
+    feed(resp, "Content-Type: application/json\n");
+    assert(resp.get_header("range") == "");
+    assert(resp.get_header("content-type") == "application/json");
+
+    resp.clear();
+    assert(resp.get_header("content-type") == "");
+
+    // curl and the received text agree, also once the response is cleared
+    Server server;
+    start(server);
+    pthread_t thread;
+    pthread_create(&thread, NULL, serve, &server);
+    HttpRequest* request = new HttpRequest("http://127.0.0.1:" + VarString::itos(server.port) + "/", RM_GET);
+    HttpResponse& served = request->request();
+    pthread_join(thread, NULL);
+    close(server.fd);
+    HttpResponse copy = served;
+    assert(served.status() == 200);
+    assert(served.get_header("x-request-number") == "1");
+    assert(served.find_header("X-Request-Number", value, length) && length == 1);
+    served.clear();
+    assert(served.get_header("X-Request-Number") == "");
+    assert(!served.find_header("X-Request-Number", value, length));
+
+    // a copy outlives the request and its curl handle
+    delete request;
+    assert(copy.get_header("X-Request-Number") == "1");
+    HttpResponse assigned;
+    assigned = copy;
+    assert(assigned.status() == 200 && assigned.get_header("x-request-number") == "1");
+
+    std::cout << "HttpResponse headers OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <stdio.h>
+
+using namespace GDRIVE;
+
+const char* PAGE =
+    "{\"kind\": \"drive#fileList\", \"etag\": \"\\\"e1\\\"\",\n"
+    " \"items\": [\n"
+    "  {\"id\": \"a\", \"title\": \"brace } in [title]\", \"parents\": [{\"id\": \"r\"}]},\n"
+    "  {\"id\": \"b\", \"title\": \"quote \\\" and \\\\\", \"labels\": {\"trashed\": true}},\n"
+    "  {\"id\": \"c\", \"title\": \"items\"}\n"
+    " ],\n"
+    " \"nextPageToken\": \"next\"}";
+
+struct Seen {
+    std::vector<std::string> ids;
+    std::vector<size_t> received;
+    size_t bytes;
+};
+
+void on_item(GFile& file, void* context) {
+    Seen* seen = (Seen*)context;
+    seen->ids.push_back(file.get_id());
+    seen->received.push_back(seen->bytes);
+}
+
+int main() {
+    // feed one byte at a time, items show up before the page is complete
+    Seen seen;
+    ItemStream<GFile> stream(on_item, &seen);
+    std::string page(PAGE);
+    std::string content;
+    for (int i = 0; i < page.size(); i ++) {
+        content += page[i];
+        seen.bytes = content.size();
+        stream.feed(content);
+    }
+    assert(stream.succeeded());
+    assert(seen.ids.size() == 3);
+    assert(seen.ids[0] == "a" && seen.ids[1] == "b" && seen.ids[2] == "c");
+    assert(seen.received[2] < page.size());
+    assert(stream.items()[0].get_title() == "brace } in [title]");
+    assert(stream.items()[1].get_labels().trashed);
+
+    GFileList list;
+    std::string envelope = stream.envelope(content);
+    JsonReader reader(envelope);
+    list.from_json(reader);
+    assert(list.get_items().size() == 0);
+    assert(list.get_nextPageToken() == "next");
+    list.swap_items(stream.items());
+    assert(list.get_items().size() == 3);
+
+    // a truncated page is reported so the caller can fall back
+    ItemStream<GFile> partial;
+    partial.feed(page.substr(0, page.find("\"c\"")));
+    assert(!partial.succeeded() && partial.items().size() == 2);
+    partial.reset();
+    assert(partial.items().size() == 0);
+
+    // chunks arrive through the curl write callback
+    const char* path = "/tmp/gdrive_test_itemstream.json";
+    FILE* fp = fopen(path, "w");
+    fputs(PAGE, fp);
+    fclose(fp);
+    Seen fetched;
+    fetched.bytes = 0;
+    ItemStream<GFile> sink(on_item, &fetched);
+    HttpRequest request(std::string("file://") + path, RM_GET);
+    request.response().set_sink(&sink);
+    request.request();
+    request.response().set_sink(NULL);
+    remove(path);
+    assert(sink.succeeded() && fetched.ids.size() == 3);
+    assert(request.response().content() == page);
+    assert(request.response().content_view() == page);
+
+    std::cout << "ItemStream OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <string.h>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+const char* FILE_LIST =
+    "{\"kind\": \"drive#fileList\", \"etag\": \"\\\"e1\\\"\", \"nextPageToken\": \"tok\",\n"
+    " \"items\": [\n"
+    "  {\"kind\": \"drive#file\", \"id\": \"a\", \"title\": \"caf\\u00e9 \\\"notes\\\"\",\n"
+    "   \"mimeType\": \"text/plain\", \"labels\": {\"starred\": true, \"trashed\": false},\n"
+    "   \"modifiedDate\": \"2014-03-10T10:20:30.000Z\", \"fileSize\": 1024,\n"
+    "   \"parents\": [{\"id\": \"p1\", \"isRoot\": false}, {\"id\": \"r\", \"isRoot\": true}],\n"
+    "   \"exportLinks\": {\"application/pdf\": \"http://x/pdf\"},\n"
+    "   \"ownerNames\": [\"alice\", \"bob\"],\n"
+    "   \"owners\": [{\"displayName\": \"alice\", \"picture\": {\"url\": \"http://x/a.png\"}}],\n"
+    "   \"unknown\": {\"nested\": [1, 2, {\"deep\": \"]}\"}]},\n"
+    "   \"imageMediaMetadata\": {\"width\": 640, \"location\": {\"latitude\": 1.5}}},\n"
+    "  {\"id\": \"b\", \"labels\": {}, \"parents\": []}\n"
+    " ]}";
+
+int main() {
+    // streaming and DOM decoding agree
+    GFileList streamed;
+    JsonReader reader(FILE_LIST, strlen(FILE_LIST));
+    streamed.from_json(reader);
+
+    GFileList dom;
+    PError error;
+    JObject* obj = (JObject*)loads(FILE_LIST, error);
+    assert(obj != NULL);
+    dom.from_json(obj);
+    delete obj;
+
+    assert(streamed.get_etag() == dom.get_etag());
+    assert(streamed.get_nextPageToken() == "tok");
+    std::vector<GFile> items = streamed.get_items();
+    std::vector<GFile> expected = dom.get_items();
+    assert(items.size() == 2 && expected.size() == 2);
+    for (int i = 0; i < items.size(); i ++) {
+        assert(items[i].get_id() == expected[i].get_id());
+        assert(items[i].get_title() == expected[i].get_title());
+        assert(items[i].get_mimeType() == expected[i].get_mimeType());
+        assert(items[i].get_fileSize() == expected[i].get_fileSize());
+        assert(items[i].get_labels().starred == expected[i].get_labels().starred);
+        assert(items[i].get_parents().size() == expected[i].get_parents().size());
+        assert(items[i].get_modifiedDate().tm_mday == expected[i].get_modifiedDate().tm_mday);
+    }
+    GFile a = items[0];
+    assert(a.get_title() == "caf\xc3\xa9 \"notes\"");
+    assert(a.get_parents()[1].get_isRoot());
+    assert(a.get_exportLinks().at("application/pdf") == "http://x/pdf");
+    assert(a.get_ownerNames().size() == 2);
+    assert(a.get_owners()[0].picture_url == "http://x/a.png");
+    assert(a.get_imageMediaMetadata().width == 640);
+    assert(a.get_imageMediaMetadata().location.latitude == 1.5);
+    assert(items[1].get_title() == "");
+
+    // null leaves the field untouched
+    GFile nulls;
+    std::string null_body = "{\"id\": \"c\", \"title\": null, \"labels\": null, \"parents\": null}";
+    JsonReader null_reader(null_body);
+    nulls.from_json(null_reader);
+    assert(nulls.get_id() == "c" && nulls.get_title() == "" && nulls.get_parents().size() == 0);
+
+    // a projection keeps only the requested fields
+    GFileProjection projection;
+    projection.add(GF_id).add(GF_title).add(GF_parents);
+    assert(projection.to_fields() == "id,title,parents");
+    assert(projection.to_list_fields() == "nextPageToken,items(id,title,parents)");
+    assert(GFileProjection::field("md5Checksum") == GF_md5Checksum);
+    assert(GFileProjection::field("kind") == -1);
+    GFileList projected;
+    JsonReader projected_reader(FILE_LIST, strlen(FILE_LIST));
+    projected.from_json(projected_reader, projection.mask());
+    GFile p = projected.get_items()[0];
+    assert(p.get_id() == "a" && p.get_parents().size() == 2);
+    assert(p.get_mimeType() == "" && p.get_fileSize() == -1 && p.get_owners().size() == 0);
+    assert(projected.get_nextPageToken() == "tok");
+
+    // int64 fields arrive quoted
+    GFile quoted;
+    std::string quoted_body = "{\"fileSize\": \"2048\", \"quotaBytesUsed\": \"-1\"}";
+    JsonReader quoted_reader(quoted_body);
+    quoted.from_json(quoted_reader);
+    assert(quoted.get_fileSize() == 2048);
+
+    // error bodies nest their fields under "error"
+    GError gerror;
+    std::string error_body = "{\"error\": {\"errors\": [{\"reason\": \"notFound\"}], \"code\": 404, \"message\": \"File not found\"}}";
+    JsonReader error_reader(error_body);
+    gerror.from_json(error_reader);
+    assert(gerror.get_code() == 404);
+    assert(gerror.get_message() == "File not found");
+    assert(gerror.get_errors()[0].at("reason") == "notFound");
+
+    // malformed input reports where it stopped
+    bool thrown = false;
+    try {
+        GFile broken;
+        std::string broken_body = "{\"id\": \"a\" \"title\": \"b\"}";
+        JsonReader broken_reader(broken_body);
+        broken.from_json(broken_reader);
+    } catch (JsonParseException& e) {
+        thrown = true;
+        assert(e.position() == 11);
+    }
+    assert(thrown);
+
+    // spans point into the buffer unless the string has escapes
+    std::string spans = "{\"plain\": \"abc\", \"escaped\": \"a\\nb\", \"none\": null}";
+    JsonReader span_reader;
+    span_reader.reset(spans.data(), spans.size());
+    const char* span;
+    size_t span_size;
+    assert(span_reader.begin_object() && span_reader.next_key() && span_reader.key() == "plain");
+    assert(span_reader.read_string_span(span, span_size));
+    assert(span == spans.data() + 11 && std::string(span, span_size) == "abc");
+    assert(span_reader.next_key() && span_reader.key() == "escaped");
+    assert(span_reader.read_string_span(span, span_size) && std::string(span, span_size) == "a\nb");
+    assert(span_reader.next_key() && !span_reader.read_string_span(span, span_size));
+    assert(!span_reader.next_key());
+
+    // numbers stop at the end of the slice, not at the next byte in memory
+    std::string numbers = "1234\"";
+    JsonReader number_reader(numbers.data(), 2);
+    long long number = 0;
+    number_reader.read_number(number);
+    assert(number == 12);
+    thrown = false;
+    try {
+        number_reader.reset(numbers.data() + 4, 0);
+        number_reader.read_number(number);
+    } catch (JsonParseException& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "test_jsonreader passed" << std::endl;
+    return 0;
+}
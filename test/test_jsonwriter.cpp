@@ -0,0 +1,59 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+
+int main() {
+    JsonWriter writer;
+    writer.begin_object();
+    writer.key("a");
+    writer.value("x\"y\\z\n\x01");
+    writer.key("b");
+    writer.begin_array();
+    writer.value(1);
+    writer.value(true);
+    writer.begin_object();
+    writer.end_object();
+    writer.end_array();
+    writer.key("c");
+    writer.value(2.5);
+    writer.end_object();
+    assert(writer.str() == "{\"a\":\"x\\\"y\\\\z\\n\\u0001\",\"b\":[1,true,{}],\"c\":2.5}");
+
+    // only the modified fields of a resource are written
+    GFile file;
+    file.set_title("Report");
+    file.set_description("");
+    std::vector<GParent> parents(1);
+    parents[0].set_id("p1");
+    file.set_parents(parents);
+    std::set<std::string> names = file.get_modified_fields();
+    assert(names.size() == 3 && names.count("title") && names.count("description") && names.count("parents"));
+    assert(file.get_modified_mask() == (FIELD_BIT(GFile::F_title) | FIELD_BIT(GFile::F_description) | FIELD_BIT(GFile::F_parents)));
+    writer.reset();
+    file.to_json(writer, file.get_modified_mask());
+    assert(writer.str() == "{\"title\":\"Report\",\"parents\":[{\"id\":\"p1\",\"isRoot\":false}]}");
+
+    // and read back the same way they were written
+    GFile copy;
+    JsonReader reader(writer.str());
+    copy.from_json(reader);
+    assert(copy.get_title() == "Report" && copy.get_parents()[0].get_id() == "p1");
+
+    // the buffer is handed over without copying and reused afterwards
+    std::string body;
+    writer.swap(body);
+    assert(body.size() != 0 && writer.str().size() == 0);
+    writer.reset();
+    GPermission permission;
+    permission.set_role("reader");
+    permission.to_json(writer, permission.get_modified_mask());
+    assert(writer.str() == "{\"role\":\"reader\"}");
+    permission.clear();
+    assert(permission.get_modified_mask() == 0 && permission.get_modified_fields().size() == 0);
+
+    std::cout << "JsonWriter OK" << std::endl;
+    return 0;
+}
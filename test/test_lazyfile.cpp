@@ -0,0 +1,121 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <string.h>
+
+using namespace GDRIVE;
+
+const char* PAGE =
+    "{\"kind\": \"drive#fileList\", \"nextPageToken\": \"next\",\n"
+    " \"items\": [\n"
+    "  {\"kind\": \"drive#file\", \"id\": \"a\", \"title\": \"caf\\u00e9 \\\"notes\\\" \\\\ [draft]\",\n"
+    "   \"mimeType\": \"text/plain\", \"labels\": {\"starred\": true, \"trashed\": false},\n"
+    "   \"modifiedDate\": \"2014-03-10T10:20:30.000Z\", \"fileSize\": \"1024\", \"quotaBytesUsed\": 2048,\n"
+    "   \"parents\": [{\"id\": \"p1\", \"isRoot\": false}, {\"id\": \"r\", \"isRoot\": true}],\n"
+    "   \"exportLinks\": {\"application/pdf\": \"http://x/pdf?a=1&b=2\"},\n"
+    "   \"ownerNames\": [\"alice\", \"bob\"],\n"
+    "   \"owners\": [{\"displayName\": \"alice\", \"picture\": {\"url\": \"http://x/a.png\"}},\n"
+    "              {\"displayName\": \"bob\", \"isAuthenticatedUser\": true}],\n"
+    "   \"unknown\": {\"title\": \"nested, not the title\", \"id\": [1, 2, {\"deep\": \"]}\"}]},\n"
+    "   \"editable\": true, \"md5Checksum\": \"9e107d9d372bb6826bd81d3542a419d6\",\n"
+    "   \"imageMediaMetadata\": {\"width\": 640, \"location\": {\"latitude\": 1.5}}},\n"
+    "  {\"id\": \"b\"},\n"
+    "  {\"id\": \"c\", \"title\": \"\", \"parents\": [], \"owners\": []}\n"
+    " ]}";
+
+static void same(const LazyGFile& lazy, const GFile& file) {
+    assert(lazy.get_id() == file.get_id());
+    assert(lazy.get_title() == file.get_title());
+    assert(lazy.get_mimeType() == file.get_mimeType());
+    assert(lazy.get_description() == file.get_description());
+    assert(lazy.get_md5Checksum() == file.get_md5Checksum());
+    assert(lazy.get_fileSize() == file.get_fileSize());
+    assert(lazy.get_quotaBytesUsed() == file.get_quotaBytesUsed());
+    assert(lazy.get_editable() == file.get_editable());
+    assert(lazy.get_shared() == file.get_shared());
+    assert(lazy.get_labels().starred == file.get_labels().starred);
+    assert(lazy.get_labels().trashed == file.get_labels().trashed);
+    assert(lazy.get_exportLinks() == file.get_exportLinks());
+    assert(lazy.get_ownerNames() == file.get_ownerNames());
+    assert(lazy.get_imageMediaMetadata().width == file.get_imageMediaMetadata().width);
+
+    struct tm a = lazy.get_modifiedDate();
+    struct tm b = file.get_modifiedDate();
+    assert(a.tm_year == b.tm_year && a.tm_mon == b.tm_mon && a.tm_mday == b.tm_mday);
+    assert(a.tm_hour == b.tm_hour && a.tm_min == b.tm_min && a.tm_sec == b.tm_sec);
+
+    std::vector<GParent> lazy_parents = lazy.get_parents();
+    const std::vector<GParent>& parents = file.get_parents();
+    assert(lazy_parents.size() == parents.size());
+    for (int i = 0; i < parents.size(); i ++) {
+        assert(lazy_parents[i].get_id() == parents[i].get_id());
+        assert(lazy_parents[i].get_isRoot() == parents[i].get_isRoot());
+    }
+    std::vector<GUser> lazy_owners = lazy.get_owners();
+    const std::vector<GUser>& owners = file.get_owners();
+    assert(lazy_owners.size() == owners.size());
+    for (int i = 0; i < owners.size(); i ++) {
+        assert(lazy_owners[i].displayName == owners[i].displayName);
+        assert(lazy_owners[i].picture_url == owners[i].picture_url);
+        assert(lazy_owners[i].isAuthenticatedUser == owners[i].isAuthenticatedUser);
+    }
+}
+
+int main() {
+    GFileList eager;
+    JsonReader reader(PAGE, strlen(PAGE));
+    eager.from_json(reader);
+
+    LazyFileList lazy;
+    JsonReader lazy_reader(PAGE, strlen(PAGE));
+    lazy.from_json(lazy_reader);
+    assert(lazy.get_nextPageToken() == "next");
+    assert(lazy.get_items().size() == 3 && eager.get_items().size() == 3);
+    for (int i = 0; i < 3; i ++) {
+        same(lazy.get_items()[i], eager.get_items()[i]);
+    }
+
+    // keys of nested objects are not taken for fields of the file
+    const LazyGFile& a = lazy.get_items()[0];
+    assert(a.get_title() == "caf\xc3\xa9 \"notes\" \\ [draft]");
+    assert(a.get_owners()[0].picture_url == "http://x/a.png");
+    assert(a.raw()[0] == '{' && a.raw()[a.raw().size() - 1] == '}');
+
+    // missing fields read as the GFile defaults
+    const LazyGFile& b = lazy.get_items()[1];
+    assert(b.has(GF_id) && !b.has(GF_title) && !b.has(GF_parents));
+    assert(b.get_title() == "" && b.get_fileSize() == eager.get_items()[1].get_fileSize());
+    assert(b.get_parents().size() == 0 && b.get_owners().size() == 0);
+    assert(lazy.get_items()[2].has(GF_title) && lazy.get_items()[2].get_title() == "");
+
+    // to_gfile builds the same object an eager decode does
+    GFile full = a.to_gfile();
+    same(a, full);
+
+    // the ListLazy path, items cut out of the page as it streams in
+    ItemStream<LazyGFile> stream;
+    stream.feed(std::string(PAGE));
+    assert(stream.succeeded() && stream.items().size() == 3);
+    for (int i = 0; i < 3; i ++) {
+        same(stream.items()[i], eager.get_items()[i]);
+    }
+
+    // a value of the wrong type is reported when its getter runs
+    LazyGFile wrong("{\"id\": \"w\", \"fileSize\": [1]}");
+    assert(wrong.get_id() == "w");
+    bool thrown = false;
+    try {
+        wrong.get_fileSize();
+    } catch (JsonParseException& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // the view is its raw bytes and one offset per field, not a built GFile
+    assert(sizeof(LazyGFile) <= sizeof(std::string) + GF_FIELD_COUNT * sizeof(uint32_t) + sizeof(void*));
+    assert(sizeof(LazyGFile) * 8 < sizeof(GFile));
+
+    std::cout << "LazyGFile OK, " << sizeof(LazyGFile) << " bytes against " << sizeof(GFile) << std::endl;
+    return 0;
+}
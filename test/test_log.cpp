@@ -0,0 +1,87 @@
+// GDRIVE_LOG_INFO, debug calls are compiled out
+#define GDRIVE_LOG_LEVEL 1
+#include "gdrive/log.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+
+using namespace GDRIVE;
+
+static volatile int received = 0;
+static volatile int with_fields = 0;
+
+static void collect(const LogRecord& record, void* context) {
+    received ++;
+    if (record.request_id == 7 && strcmp(record.endpoint, "files.get") == 0 && record.status == 200) {
+        with_fields ++;
+    }
+}
+
+static void* worker(void* arg) {
+    for (int i = 0; i < 500; i ++) {
+        GLOG_INFO("item %d\n", i);
+        GLOG_REQUEST(GDRIVE_LOG_WARN, 7, "files.get", 200, "done\n");
+    }
+    return NULL;
+}
+
+static int side_effect() {
+    assert(false);
+    return 0;
+}
+
+int main() {
+    AsyncLog& log = AsyncLog::shared();
+    log.set_function(collect, NULL);
+
+    // below the compiled level neither the call nor its arguments run
+    GLOG_DEBUG("never %d\n", side_effect());
+
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i ++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < 4; i ++) {
+        pthread_join(threads[i], NULL);
+    }
+    log.flush();
+    assert(received + (int)log.dropped() == 4000);
+    assert(with_fields + (int)log.dropped() >= 2000);
+
+    // the runtime level drops records before formatting them
+    log.set_level(GDRIVE_LOG_ERROR);
+    int before = received;
+    GLOG_WARN("filtered\n");
+    GLOG_ERROR("kept\n");
+    log.flush();
+    assert(received == before + 1);
+
+    // an idle writer sleeps until a record comes, and stops when asked
+    AsyncLog* idle = new AsyncLog();
+    idle->set_function(collect, NULL);
+    before = received;
+    usleep(20000);
+    idle->log(GDRIVE_LOG_ERROR, 0, NULL, 0, "late\n");
+    idle->flush();
+    assert(received == before + 1);
+    usleep(20000);
+    delete idle;
+
+    LogRecord record;
+    record.level = GDRIVE_LOG_WARN;
+    record.time_ms = 1394446830000LL;
+    record.request_id = 42;
+    record.status = 503;
+    strcpy(record.endpoint, "files.list");
+    strcpy(record.message, "backend \"busy\"\n");
+    char line[256];
+    AsyncLog::format(record, line, sizeof(line));
+    assert(std::string(line) == "ts=2014-03-10T10:20:30.000Z level=warn req=42 endpoint=files.list status=503 msg=\"backend \\\"busy\\\"\"");
+
+    std::cout << "AsyncLog OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+GFile make_file(std::string id, std::string title, std::string mime, std::string modified,
+        std::string parent, bool trashed = false) {
+    std::string repr = "{\"id\": \"" + id + "\", \"title\": \"" + title + "\", "
+                     + "\"mimeType\": \"" + mime + "\", "
+                     + "\"modifiedDate\": \"" + modified + "\", "
+                     + "\"labels\": {\"trashed\": " + (trashed ? "true" : "false") + "}, "
+                     + "\"parents\": [{\"id\": \"" + parent + "\", \"isRoot\": " + (parent == "r0" ? "true" : "false") + "}]}";
+    GFile file;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    file.from_json(obj);
+    delete obj;
+    return file;
+}
+
+int main() {
+    MetadataCache cache;
+    std::vector<GFile> files;
+    files.push_back(make_file("a", "Quarterly Report", "application/pdf", "2014-01-10T10:00:00.000Z", "r0"));
+    files.push_back(make_file("b", "report draft", "text/plain", "2014-02-10T10:00:00.000Z", "f1"));
+    files.push_back(make_file("c", "photo", "image/jpeg", "2014-03-10T10:00:00.000Z", "f1"));
+    files.push_back(make_file("d", "old report", "application/pdf", "2013-12-10T10:00:00.000Z", "f1", true));
+    cache.put(files);
+    assert(cache.size() == 4);
+
+    std::vector<std::string> ids = cache.query_ids("mimeType = 'application/pdf'");
+    assert(ids.size() == 2);
+    ids = cache.query_ids("mimeType = 'application/pdf' and trashed = false");
+    assert(ids.size() == 1 && ids[0] == "a");
+    ids = cache.query_ids("title contains 'REPORT' and not trashed = true");
+    assert(ids.size() == 2);
+    ids = cache.query_ids("'f1' in parents and modifiedDate >= '2014-02-10T10:00:00'");
+    assert(ids.size() == 2);
+    ids = cache.query_ids("modifiedDate < '2014-01-01' or mimeType != 'application/pdf'");
+    assert(ids.size() == 3);
+    ids = cache.query_ids("'root' in parents");
+    assert(ids.size() == 1 && ids[0] == "a");
+    ids = cache.query_ids("(title = 'photo' or title = 'report draft') and 'f1' in parents");
+    assert(ids.size() == 2);
+
+    // indexes follow updates and removals
+    GFile moved = make_file("c", "photo", "image/png", "2014-03-10T10:00:00.000Z", "f2");
+    cache.put(moved);
+    assert(cache.query_ids("'f1' in parents").size() == 2);
+    assert(cache.query_ids("mimeType = 'image/png'").size() == 1);
+    cache.remove("a");
+    assert(cache.query_ids("'root' in parents").size() == 0);
+
+    bool thrown = false;
+    try {
+        cache.query_ids("fullText contains 'x'");
+    } catch (QueryException& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "MetadataCache OK" << std::endl;
+}
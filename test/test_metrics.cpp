@@ -0,0 +1,112 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <stdio.h>
+
+using namespace GDRIVE;
+
+static Metrics* metrics;
+
+static void* worker(void* arg) {
+    int id = metrics->endpoint("files.list");
+    TransferTiming timing;
+    timing.total = 30000;
+    timing.bytes_down = 100;
+    for (int i = 0; i < 1000; i ++) {
+        metrics->record(id, 200, timing, false);
+    }
+    return NULL;
+}
+
+static void collect(const std::string& text, void* context) {
+    *(std::string*)context = text;
+}
+
+static bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+int main() {
+    // endpoints are named after the collection and the method
+    assert(Metrics::endpoint_name(RM_GET, FILES_URL) == "files.list");
+    assert(Metrics::endpoint_name(RM_GET, FILES_URL "/abc") == "files.get");
+    assert(Metrics::endpoint_name(RM_PATCH, FILES_URL "/abc?fields=id") == "files.patch");
+    assert(Metrics::endpoint_name(RM_POST, FILES_URL "/abc/copy") == "files.copy");
+    assert(Metrics::endpoint_name(RM_DELETE, FILES_URL "/trash") == "files.emptyTrash");
+    assert(Metrics::endpoint_name(RM_GET, FILES_URL "/abc/children") == "children.list");
+    assert(Metrics::endpoint_name(RM_DELETE, FILES_URL "/abc/comments/c/replies/r") == "replies.delete");
+    assert(Metrics::endpoint_name(RM_GET, CHANGES_URL) == "changes.list");
+    assert(Metrics::endpoint_name(RM_GET, ABOUT_URL) == "about.get");
+    assert(Metrics::endpoint_name(RM_POST, FILE_UPLOAD_URL "?uploadType=multipart") == "files.upload");
+    assert(Metrics::endpoint_name(RM_POST, TOKEN_URL) == "other");
+
+    metrics = new Metrics();
+    int get = metrics->endpoint("files.get");
+    assert(get == metrics->endpoint("files.get") && get != metrics->endpoint("files.list"));
+
+    // every thread records into its own shard, export sums them
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i ++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < 4; i ++) {
+        pthread_join(threads[i], NULL);
+    }
+    TransferTiming slow;
+    slow.total = 2000000;
+    slow.bytes_up = 10;
+    metrics->record(get, 200, slow, false);
+    metrics->record(get, 429, slow, true);
+    metrics->record(get, 0, TransferTiming(), false);
+    metrics->record_refresh();
+
+    // threads started one after another reuse the shard of the last one
+    pthread_create(&threads[0], NULL, worker, NULL);
+    pthread_join(threads[0], NULL);
+    size_t usage = metrics->memory_usage();
+    for (int i = 0; i < 19; i ++) {
+        pthread_create(&threads[0], NULL, worker, NULL);
+        pthread_join(threads[0], NULL);
+    }
+    assert(metrics->memory_usage() == usage);
+
+    std::string text;
+    metrics->export_to(collect, &text);
+    assert(contains(text, "# TYPE gdrive_request_duration_seconds histogram"));
+    assert(contains(text, "gdrive_request_duration_seconds_bucket{endpoint=\"files.list\",le=\"0.025\"} 0"));
+    assert(contains(text, "gdrive_request_duration_seconds_bucket{endpoint=\"files.list\",le=\"0.05\"} 24000"));
+    assert(contains(text, "gdrive_request_duration_seconds_bucket{endpoint=\"files.list\",le=\"+Inf\"} 24000"));
+    assert(contains(text, "gdrive_request_duration_seconds_sum{endpoint=\"files.list\"} 720.000000"));
+    assert(contains(text, "gdrive_request_duration_seconds_count{endpoint=\"files.get\"} 3"));
+    assert(contains(text, "gdrive_request_duration_seconds_bucket{endpoint=\"files.get\",le=\"2.5\"} 3"));
+    assert(contains(text, "gdrive_requests_total{endpoint=\"files.list\",code=\"2xx\"} 24000"));
+    assert(contains(text, "gdrive_requests_total{endpoint=\"files.get\",code=\"4xx\"} 1"));
+    assert(contains(text, "gdrive_requests_total{endpoint=\"files.get\",code=\"error\"} 1"));
+    assert(contains(text, "gdrive_transfer_bytes_total{endpoint=\"files.list\",direction=\"received\"} 2400000"));
+    assert(contains(text, "gdrive_transfer_bytes_total{endpoint=\"files.get\",direction=\"sent\"} 20"));
+    assert(contains(text, "gdrive_throttled_seconds_total{endpoint=\"files.get\"} 2.000000"));
+    assert(contains(text, "gdrive_token_refreshes_total 1"));
+    assert(text.find("endpoint=\"other\"") == std::string::npos);
+
+    // label values are escaped
+    metrics->record(metrics->endpoint("we\"ird\\name\n"), 200, slow, false);
+    metrics->export_to(collect, &text);
+    assert(contains(text, "gdrive_requests_total{endpoint=\"we\\\"ird\\\\name\\n\",code=\"2xx\"} 1"));
+
+    // a dump holds the same text
+    std::string path = "/tmp/gdrive_metrics.prom";
+    assert(metrics->dump(path));
+    std::ifstream in(path.c_str());
+    std::stringstream dumped;
+    dumped << in.rdbuf();
+    assert(dumped.str() == text);
+    remove(path.c_str());
+
+    delete metrics;
+    std::cout << "Metrics OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+GFile make_file(std::string repr) {
+    GFile file;
+    PError error;
+    JObject* obj = (JObject*)loads(repr, error);
+    assert(obj != NULL);
+    file.from_json(obj);
+    delete obj;
+    return file;
+}
+
+int main() {
+    std::vector<GFile> files;
+    files.push_back(make_file("{\"id\": \"f_projects\", \"title\": \"projects\", \"parents\": [{\"id\": \"r0\", \"isRoot\": true}]}"));
+    files.push_back(make_file("{\"id\": \"f_2026\", \"title\": \"2026\", \"parents\": [{\"id\": \"f_projects\", \"isRoot\": false}]}"));
+    files.push_back(make_file("{\"id\": \"b_report\", \"title\": \"report.pdf\", \"parents\": [{\"id\": \"f_2026\", \"isRoot\": false}]}"));
+    files.push_back(make_file("{\"id\": \"a_report\", \"title\": \"report.pdf\", \"parents\": [{\"id\": \"f_2026\", \"isRoot\": false}]}"));
+    files.push_back(make_file("{\"id\": \"t_report\", \"title\": \"trashed.pdf\", \"labels\": {\"trashed\": true}, \"parents\": [{\"id\": \"f_2026\", \"isRoot\": false}]}"));
+
+    PathIndex index;
+    index.add(files);
+
+    std::string id;
+    assert(index.resolve("/projects/2026", id) && id == "f_2026");
+    assert(index.resolve("projects//2026/", id) && id == "f_2026");
+    assert(index.resolve("/", id) && id == ROOT_FOLDER_ALIAS);
+
+    // duplicate titles resolve to the smallest id
+    assert(index.resolve("/projects/2026/report.pdf", id) && id == "a_report");
+    assert(index.lookup_all("f_2026", "report.pdf").size() == 2);
+    assert(!index.resolve("/projects/2026/trashed.pdf", id));
+
+    // deleting the winner falls back to the remaining duplicate
+    GChange change;
+    PError error;
+    JObject* obj = (JObject*)loads("{\"fileId\": \"a_report\", \"deleted\": true}", error);
+    change.from_json(obj);
+    delete obj;
+    index.apply(change);
+    assert(index.resolve("/projects/2026/report.pdf", id) && id == "b_report");
+
+    // a rename moves the entry to its new title
+    obj = (JObject*)loads("{\"fileId\": \"f_2026\", \"deleted\": false, \"file\": {\"id\": \"f_2026\", \"title\": \"2027\", \"parents\": [{\"id\": \"f_projects\", \"isRoot\": false}]}}", error);
+    GChange rename;
+    rename.from_json(obj);
+    delete obj;
+    index.apply(rename);
+    assert(!index.resolve("/projects/2026/report.pdf", id));
+    assert(index.resolve("/projects/2027/report.pdf", id) && id == "b_report");
+
+    // a fresh listing replaces the entries of a renamed file
+    GFile renamed = make_file("{\"id\": \"b_report\", \"title\": \"summary.pdf\", \"parents\": [{\"id\": \"f_2026\", \"isRoot\": false}]}");
+    index.add(renamed);
+    assert(!index.resolve("/projects/2027/report.pdf", id));
+    assert(index.resolve("/projects/2027/summary.pdf", id) && id == "b_report");
+
+    // and a file trashed since stops resolving
+    GFile trashed = make_file("{\"id\": \"b_report\", \"title\": \"summary.pdf\", \"labels\": {\"trashed\": true}, \"parents\": [{\"id\": \"f_2026\", \"isRoot\": false}]}");
+    index.add(trashed);
+    assert(!index.resolve("/projects/2027/summary.pdf", id));
+
+    index.clear();
+    assert(index.size() == 0);
+    std::cout << "PathIndex OK" << std::endl;
+}
@@ -0,0 +1,145 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace GDRIVE;
+
+class MemoryStore : public Store {
+    public:
+        std::string get(std::string key) { return _values[key]; }
+        void put(std::string key, std::string value) { _values[key] = value; }
+        bool dump() { return true; }
+    private:
+        std::map<std::string, std::string> _values;
+};
+
+// serves three pages of files.list over plain http and keeps the request lines
+struct Server {
+    int fd;
+    int port;
+    int count;
+    std::vector<std::string> requests;
+};
+
+static std::string page(const std::string& target) {
+    if (target.find("pageToken=broken") != std::string::npos) {
+        return "{\"kind\": \"drive#fileList\", \"items\": [{\"id\": \"f1a\", \"title\": }]}";
+    }
+    std::string token = "1";
+    size_t pos = target.find("pageToken=");
+    if (pos != std::string::npos) {
+        token = target.substr(pos + 10, 1);
+    }
+    std::string next = token == "3" ? "" : std::string(1, token[0] + 1);
+    return "{\"kind\": \"drive#fileList\", \"nextPageToken\": \"" + next + "\", \"items\": ["
+           "{\"id\": \"f" + token + "a\", \"title\": \"a\", \"description\": \"not projected\"},"
+           "{\"id\": \"f" + token + "b\", \"title\": \"b\", \"description\": \"not projected\"}]}";
+}
+
+static void* serve(void* arg) {
+    Server* server = (Server*)arg;
+    for (int i = 0; i < server->count; i ++) {
+        int client = accept(server->fd, NULL, NULL);
+        std::string request;
+        char buf[4096];
+        while (request.find("\r\n\r\n") == std::string::npos) {
+            ssize_t n = recv(client, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            request.append(buf, n);
+        }
+        std::string line = request.substr(0, request.find("\r\n"));
+        server->requests.push_back(line);
+        std::string body = page(line);
+        std::string resp = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n"
+                           "Content-Length: " + VarString::itos(body.size()) + "\r\n\r\n" + body;
+        send(client, resp.data(), resp.size(), 0);
+        close(client);
+    }
+    return NULL;
+}
+
+static void start(Server& server, int count) {
+    server.fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    assert(bind(server.fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    assert(listen(server.fd, 4) == 0);
+    socklen_t length = sizeof(addr);
+    getsockname(server.fd, (struct sockaddr*)&addr, &length);
+    server.port = ntohs(addr.sin_port);
+    server.count = count;
+}
+
+int main() {
+    MemoryStore store;
+    store.put("access_token", "token");
+    store.put("refresh_token", "refresh");
+    Credential cred(&store);
+
+    Server server;
+    start(server, 5);
+    pthread_t thread;
+    pthread_create(&thread, NULL, serve, &server);
+    std::string url = "http://127.0.0.1:" + VarString::itos(server.port) + "/drive/v2/files";
+
+    // every page of a projected listing asks for the projection, clear()
+    // between pages wipes the query
+    GFileProjection projection;
+    projection.add(GF_id).add(GF_title);
+    FileListRequest list(&cred, url);
+    list.set_projection(projection);
+    std::vector<GFile> files;
+    while (true) {
+        GFileList filelist = list.execute();
+        move_items(filelist, files);
+        list.clear();
+        std::string token = filelist.get_nextPageToken();
+        if (token == "") {
+            break;
+        }
+        list.set_pageToken(token);
+    }
+    assert(files.size() == 6);
+    assert(files[0].get_id() == "f1a" && files[5].get_id() == "f3b");
+    for (int i = 0; i < files.size(); i ++) {
+        assert(files[i].get_description() == "");
+    }
+    assert(server.requests.size() == 3);
+    for (int i = 0; i < 3; i ++) {
+        assert(server.requests[i].find("fields=nextPageToken") != std::string::npos);
+    }
+    assert(server.requests[2].find("pageToken=3") != std::string::npos);
+
+    // dropping the fields drops the projection with them
+    list.clear_fields();
+    GFileList full = list.execute();
+    assert(server.requests[3].find("fields=") == std::string::npos);
+    assert(full.get_items().size() == 2 && full.get_items()[0].get_description() == "not projected");
+
+    // a malformed page throws instead of coming back half decoded
+    list.clear();
+    list.set_pageToken("broken");
+    bool thrown = false;
+    try {
+        list.execute();
+    } catch (JsonParseException& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    pthread_join(thread, NULL);
+    close(server.fd);
+    std::cout << "FileListRequest projection OK" << std::endl;
+    return 0;
+}
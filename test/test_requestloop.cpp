@@ -0,0 +1,111 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace GDRIVE;
+
+static long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations ++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+// shows the url a request was last sent to
+class UrlRequest : public HttpRequest {
+    public:
+        UrlRequest(std::string uri) :HttpRequest(uri, RM_GET) {}
+        inline const std::string& url() const { return _url; }
+};
+
+int main() {
+    // insertion ordered, erased storage is reused
+    RequestQuery query;
+    query["b"] = "2";
+    query["a"] = "1";
+    query["c"] = "3";
+    assert(query.size() == 3 && query.begin()->first == "b");
+    assert(query.find("a")->second == "1" && query.find("z") == query.end());
+    query.erase("b");
+    assert(query.size() == 2 && query.begin()->first == "a");
+    RequestQuery more;
+    more["a"] = "ignored";
+    more["d"] = "4";
+    query.insert(more.begin(), more.end());
+    assert(query.size() == 3 && query["a"] == "1" && query["d"] == "4");
+
+    char path[] = "/tmp/gdrive_requestloopXXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    std::string body = "{\"kind\": \"drive#file\", \"id\": \"0B1234567890abcdefghijklmnop\"}";
+    assert(write(fd, body.data(), body.size()) == (ssize_t)body.size());
+    close(fd);
+
+    // the same request sent again, as a Get loop does, allocates nothing
+    HttpRequest request(std::string("file://") + path, RM_GET);
+    std::string token = "Bearer ya29.a0AfH6SMBx0123456789abcdefghijklmnopqrstuvwxyz";
+    std::string agent = "google-api-cpp-client/0.1";
+    std::string fields = "id,title,mimeType,parents(id,isRoot),modifiedDate";
+    std::string q = "'root' in parents and trashed = false";
+    long before = 0;
+    for (int i = 0; i < 100; i ++) {
+        if (i == 10) {
+            before = allocations;
+        }
+        request.clear_header();
+        request.clear_query();
+        request.add_header("Authorization", token);
+        request.add_header("user-agent", agent);
+        request.add_query("fields", fields);
+        request.add_query("q", q);
+        HttpResponse& resp = request.request();
+        assert(resp.content() == body);
+    }
+    assert(allocations == before);
+
+    // the url follows every change to the query and the uri
+    UrlRequest sent(std::string("file://") + path);
+    sent.add_query("fields", "id,title");
+    sent.add_query("q", "a b");
+    sent.request();
+    assert(sent.url() == std::string("file://") + path + "?fields=id%2Ctitle&q=a%20b");
+    sent.add_query("q", "c");
+    sent.request();
+    assert(sent.url() == std::string("file://") + path + "?fields=id%2Ctitle&q=c");
+    sent.clear_query();
+    sent.add_query("q", "c");
+    sent.request();
+    assert(sent.url() == std::string("file://") + path + "?q=c");
+    sent.set_uri(std::string("file://") + path);
+    sent.clear_query();
+    sent.request();
+    assert(sent.url() == std::string("file://") + path);
+
+    // every transfer records its timing, failed ones on the exception
+    const TransferTiming& timing = request.response().timing();
+    assert(timing.bytes_down == (long long)body.size() && timing.retries == 0);
+    HttpRequest missing(std::string("file://") + path + ".missing", RM_GET);
+    bool thrown = false;
+    try {
+        missing.request();
+    } catch (CurlException& e) {
+        thrown = true;
+        assert(e.timing().bytes_down == 0);
+    }
+    assert(thrown);
+
+    unlink(path);
+    std::cout << "RequestLoop OK" << std::endl;
+    return 0;
+}
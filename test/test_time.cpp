@@ -0,0 +1,56 @@
+#include "gdrive/gdrive.hpp"
+
+#include <iostream>
+#include <cassert>
+
+using namespace GDRIVE;
+
+int main() {
+    assert(epoch_ms_from_string("1970-01-01T00:00:00.000Z") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30.000Z") == 1394446830000LL);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30.123Z") == 1394446830123LL);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30.5Z") == 1394446830500LL);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30.123456Z") == 1394446830123LL);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30") == 1394446830000LL);
+    assert(epoch_ms_from_string("2014-03-10T12:20:30+02:00") == 1394446830000LL);
+    assert(epoch_ms_from_string("2014-03-10T05:50:30-04:30") == 1394446830000LL);
+    assert(epoch_ms_from_string("2014-03-10") == 1394409600000LL);
+    assert(epoch_ms_from_string("2000-02-29T00:00:00Z") == 951782400000LL);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30.123z") == 1394446830123LL);
+    assert(epoch_ms_from_string("2014-03-10T08:20:30.123-02:00") == 1394446830123LL);
+    assert(epoch_ms_from_string("1969-12-31T23:59:59.000Z") == -1000);
+
+    // malformed values read as unset
+    assert(epoch_ms_from_string("") == 0);
+    assert(epoch_ms_from_string("2014-13-10T10:20:30Z") == 0);
+    assert(epoch_ms_from_string("2014-03-10X10:20:30Z") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30Q") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:2") == 0);
+    assert(epoch_ms_from_string("2014-02-31T10:20:30Z") == 0);
+    assert(epoch_ms_from_string("2014-04-31") == 0);
+    assert(epoch_ms_from_string("2014-02-29T00:00:00Z") == 0);
+    assert(epoch_ms_from_string("1900-02-29T00:00:00Z") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30+24:00") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30-02:60") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30+0200") == 0);
+    assert(epoch_ms_from_string("2014-03-10T10:20:30ZZ") == 0);
+
+    assert(epoch_ms_to_string(1394446830123LL) == "2014-03-10T10:20:30.123Z");
+    assert(epoch_ms_to_string(-1) == "1969-12-31T23:59:59.999Z");
+
+    // the struct tm helpers go through the same conversion
+    struct tm time = time_from_string("2014-03-10T10:20:30.000Z");
+    assert(time.tm_year == 114 && time.tm_mon == 2 && time.tm_mday == 10 && time.tm_hour == 10);
+    assert(time.tm_wday == 1 && time.tm_isdst == 0);
+    assert(time_to_epoch_ms(time) == 1394446830000LL);
+    assert(time_to_string(time) == "2014-03-10T10:20:30.000Z");
+
+    GFile file;
+    file.set_modifiedDate(time);
+    assert(file.get_modifiedDate_ms() == 1394446830000LL && file.get_modifiedDate().tm_min == 20);
+    assert(file.get_modified_fields().count("modifiedDate") == 1);
+    assert(file.get_createdDate_ms() == 0 && file.get_createdDate().tm_year == 0);
+
+    std::cout << "Time OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "gdrive/gdrive.hpp"
+#include "jconer/json.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <stdio.h>
+
+using namespace GDRIVE;
+using namespace JCONER;
+
+static void* worker(void* arg) {
+    for (int i = 0; i < 100; i ++) {
+        TraceSpan span("work", "test", "a \"quoted\" detail");
+    }
+    return NULL;
+}
+
+static int count(const std::string& text, const std::string& what) {
+    int n = 0;
+    for (size_t pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1)) {
+        n ++;
+    }
+    return n;
+}
+
+int main() {
+    Tracer& tracer = Tracer::shared();
+    // nothing is kept while off
+    {
+        TraceSpan span("ignored", "test");
+    }
+    std::string path = "/tmp/gdrive_trace.json";
+    assert(tracer.start(path) && tracer.enabled());
+    assert(!tracer.start(path));
+
+    pthread_t threads[3];
+    for (int i = 0; i < 3; i ++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+    for (int i = 0; i < 3; i ++) {
+        pthread_join(threads[i], NULL);
+    }
+    TransferTiming timing;
+    timing.namelookup = 100;
+    timing.connect = 300;
+    timing.appconnect = 900;
+    timing.pretransfer = 950;
+    timing.starttransfer = 5000;
+    timing.total = 6000;
+    tracer.transfer("files.get", Tracer::now(), 200, timing);
+    tracer.stop();
+    assert(!tracer.enabled());
+
+    std::ifstream in(path.c_str());
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    PError error;
+    JObject* trace = (JObject*)loads(text, error);
+    assert(trace != NULL);
+    delete trace;
+    assert(count(text, "\"name\":\"work\"") == 300);
+    assert(count(text, "\"ignored\"") == 0);
+    assert(count(text, "a \\\"quoted\\\" detail") == 300);
+    assert(count(text, "\"detail\":\"files.get 200\"") == 1);
+    assert(count(text, "\"name\":\"tls\",\"cat\":\"http\",\"ph\":\"X\"") == 1);
+    assert(text.find("\"dur\":4100") != std::string::npos);
+    // three workers and the main thread
+    assert(count(text, "\"tid\":4") == 6 && count(text, "\"tid\":5") == 0);
+    remove(path.c_str());
+
+    std::cout << "Tracer OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "gdrive/util.hpp"
+
+#include <iostream>
+#include <cassert>
+#include <map>
+
+using namespace GDRIVE;
+
+int main() {
+    // the bytes escaped before stay escaped
+    assert(URLHelper::encode("a b&c=d/e:f") == "a%20b%26c%3Dd%2Fe%3Af");
+    assert(URLHelper::encode("'root' in parents") == "'root'%20in%20parents");
+    assert(URLHelper::encode("id,title,parents(id)") == "id%2Ctitle%2Cparents(id)");
+    assert(URLHelper::encode("") == "");
+    assert(URLHelper::check_unsafe('#') && !URLHelper::check_unsafe('x'));
+
+    // UTF-8 is escaped byte by byte, without sign extension
+    std::string title = "title = 'caf\xc3\xa9 \xe6\x97\xa5\xe8\xa8\x98'";
+    std::string encoded = URLHelper::encode(title);
+    assert(encoded == "title%20%3D%20'caf%C3%A9%20%E6%97%A5%E8%A8%98'");
+    assert(URLHelper::check_unsafe('\xc3') && URLHelper::check_unsafe('\n'));
+
+    // appending keeps what is already there
+    std::string url = "https://x/files?q=";
+    URLHelper::encode(title.data(), title.size(), url);
+    assert(url == "https://x/files?q=" + encoded);
+
+    std::map<std::string, std::string> body;
+    body["grant_type"] = "refresh_token";
+    body["client_id"] = "a b";
+    assert(URLHelper::encode(body) == "client_id=a%20b&grant_type=refresh_token");
+    body.clear();
+    assert(URLHelper::encode(body) == "");
+
+    // decoding undoes it for every byte
+    assert(URLHelper::decode(encoded) == title);
+    std::string all;
+    for (int i = 0; i < 256; i ++) {
+        all.push_back((char)i);
+    }
+    assert(URLHelper::decode(URLHelper::encode(all)) == all);
+    assert(URLHelper::decode("a+b%2fc%2Fd") == "a b/c/d");
+    // broken escapes are kept as they are
+    assert(URLHelper::decode("100%") == "100%");
+    assert(URLHelper::decode("%zz%4") == "%zz%4");
+
+    std::cout << "URLHelper OK" << std::endl;
+    return 0;
+}